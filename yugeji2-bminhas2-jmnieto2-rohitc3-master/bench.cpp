@@ -0,0 +1,364 @@
+#include <fstream>
+using std::ifstream;
+using std::ofstream;
+using std::getline;
+
+#include <vector>
+using std::vector;
+
+#include <iostream>
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::ostream;
+
+#include <string>
+using std::string;
+using std::to_string;
+using std::stoul;
+using std::stoll;
+
+#include <sstream>
+using std::stringstream;
+
+#include <algorithm>
+using std::sort;
+using std::min;
+using std::max;
+
+#include <chrono>
+using std::chrono::steady_clock;
+using std::chrono::duration;
+
+#include <functional>
+using std::function;
+
+#include <cstdio>
+using std::snprintf;
+
+#include <stdexcept>
+
+#include <cctype>
+#include <climits>
+
+#include <random>
+using std::mt19937_64;
+using std::uniform_int_distribution;
+
+#include "graph.h"
+#include "generator.h"
+#include "parallel.h"
+
+/**
+ * Timings of one benchmark over all repetitions.
+ */
+struct BenchmarkResult {
+  string name;
+  size_t operations = 0;   // Operations done by each repetition.
+  vector<double> times;    // Seconds taken by each repetition, sorted.
+};
+
+/**
+ * Transaction as read from input file.
+ */
+struct Transaction {
+  string sender;
+  long long amount;
+  string recipient;
+};
+
+// Results of benchmarks are added here so the compiler cannot remove them.
+static volatile size_t sink = 0;
+
+/**
+ * @brief Time function over repetitions after untimed warmup runs.
+ *
+ * @param name            Name of benchmark.
+ * @param warmup          Number of untimed runs.
+ * @param repetitions     Number of timed runs.
+ * @param operations      Operations done by each run, for throughput.
+ * @param benchmark       Benchmarked function.
+ * @return BenchmarkResult Sorted timings of runs.
+ */
+BenchmarkResult runBenchmark(const string& name, size_t warmup, size_t repetitions, size_t operations,
+                             const function<void()>& benchmark) {
+  cerr << "Running " << name << "..." << endl;
+
+  for (size_t i = 0; i < warmup; ++i)
+    benchmark();
+
+  BenchmarkResult result;
+  result.name = name;
+  result.operations = operations;
+
+  for (size_t i = 0; i < repetitions; ++i) {
+    steady_clock::time_point start = steady_clock::now();
+    benchmark();
+    duration<double> elapsed = steady_clock::now() - start;
+    result.times.push_back(elapsed.count());
+  }
+
+  sort(result.times.begin(), result.times.end());
+
+  return result;
+}
+
+/**
+ * @brief Get percentile of sorted timings by nearest rank.
+ *
+ * @param times      Sorted timings.
+ * @param percentile Percentile between 0 and 100.
+ * @return double    Timing at percentile.
+ */
+double getPercentile(const vector<double>& times, double percentile) {
+  if (times.empty())
+    return 0;
+
+  size_t rank = (size_t) (percentile / 100 * times.size() + 0.999999);
+  return times[min(times.size(), rank == 0 ? 1 : rank) - 1];
+}
+
+/**
+ * @brief Parse whole argument as an unsigned number, unlike stoul 
+ * which ignores trailing characters and wraps negative numbers.
+ *
+ * @param value          Argument to parse.
+ * @param max            Largest number accepted, so it fits its destination.
+ * @return unsigned long Number.
+ * @throws std::invalid_argument if argument is not an unsigned number.
+ * @throws std::out_of_range if number is larger than max.
+ */
+unsigned long parseUnsigned(const string& value, unsigned long max = ULONG_MAX) {
+  if (value.empty() || !isdigit((unsigned char) value[0]))
+    throw std::invalid_argument(value);
+
+  size_t length = 0;
+  unsigned long number = stoul(value, &length);
+  if (length != value.size())
+    throw std::invalid_argument(value);
+  if (number > max)
+    throw std::out_of_range(value);
+
+  return number;
+}
+
+/**
+ * @brief Escape string for a JSON string literal.
+ *
+ * @param str     String to escape.
+ * @return string Escaped string, without quotes.
+ */
+string escapeJson(const string& str) {
+  string escaped;
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+      escaped += c;
+    } else if ((unsigned char) c < 0x20) {
+      char code[7];
+      snprintf(code, sizeof(code), "\\u%04x", (unsigned char) c);
+      escaped += code;
+    } else {
+      escaped += c;
+    }
+  }
+
+  return escaped;
+}
+
+/**
+ * @brief Write benchmark results as JSON.
+ *
+ * @param out       Stream to write to.
+ * @param inputPath Path of input file.
+ * @param g         Graph benchmarked.
+ * @param results   Results of benchmarks.
+ */
+void writeResults(ostream& out, const string& inputPath, const Graph& g, const vector<BenchmarkResult>& results) {
+  out << "{\n"
+      << "  \"input\": \"" << escapeJson(inputPath) << "\",\n"
+      << "  \"addresses\": " << g.getAddressCount() << ",\n"
+      << "  \"transactions\": " << g.getTransactionCount() << ",\n"
+      << "  \"threads\": " << getThreadCount() << ",\n"
+      << "  \"benchmarks\": [\n";
+
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchmarkResult& result = results[i];
+
+    double mean = 0;
+    for (double time : result.times)
+      mean += time / result.times.size();
+
+    double median = getPercentile(result.times, 50);
+
+    out << "    {\n"
+        << "      \"name\": \"" << escapeJson(result.name) << "\",\n"
+        << "      \"repetitions\": " << result.times.size() << ",\n"
+        << "      \"operations\": " << result.operations << ",\n"
+        << "      \"min_ms\": " << result.times.front() * 1e3 << ",\n"
+        << "      \"median_ms\": " << median * 1e3 << ",\n"
+        << "      \"p99_ms\": " << getPercentile(result.times, 99) * 1e3 << ",\n"
+        << "      \"mean_ms\": " << mean * 1e3 << ",\n"
+        << "      \"operations_per_second\": " << (median > 0 ? result.operations / median : 0) << "\n"
+        << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+
+  out << "  ]\n"
+      << "}" << endl;
+}
+
+int main(int argc, const char * argv[]) {
+  // Default Values
+  string inputFilepath = "data/transactions.csv";
+  string outputFilepath;
+  size_t warmup = 1;
+  size_t repetitions = 10;
+  size_t pairCount = 100;
+  bool generate = false;
+  GeneratorOptions generatorOptions;
+
+  string currentArg;
+  for (int i = 1; i < argc; ++i) {
+    try {
+      if (currentArg == "--input-filepath") {
+        inputFilepath = argv[i];
+      } else if (currentArg == "--output") {
+        outputFilepath = argv[i];
+      } else if (currentArg == "--warmup") {
+        warmup = parseUnsigned(argv[i]);
+      } else if (currentArg == "--repetitions") {
+        repetitions = parseUnsigned(argv[i]);
+      } else if (currentArg == "--pairs") {
+        pairCount = parseUnsigned(argv[i]);
+      } else if (currentArg == "--generate-scale") {
+        generatorOptions.scale = parseUnsigned(argv[i], UINT_MAX);
+        generate = true;
+      } else if (currentArg == "--generate-transactions") {
+        generatorOptions.transactionCount = parseUnsigned(argv[i]);
+        generate = true;
+      }
+    } catch (const std::logic_error&) {
+      // Numbers are invalid or out of range.
+      cerr << "Invalid value \"" << argv[i] << "\" for " << currentArg << "!" << endl;
+      return 1;
+    }
+
+    currentArg = argv[i];
+  }
+
+  repetitions = max<size_t>(1, repetitions);
+
+  try {
+    // Benchmark on synthetic transactions when no data is available offline.
+    if (generate) {
+      inputFilepath = "data/synthetic.csv";
+      cerr << "Generating synthetic transactions to " << inputFilepath << "..." << endl;
+      writeSyntheticTransactions(inputFilepath, generatorOptions);
+    }
+
+    // Read transactions once so loading the graph can be timed apart from parsing.
+    vector<Transaction> transactions;
+    ifstream data(inputFilepath);
+    if (!data.is_open())
+      throw string("File \"" + inputFilepath + "\" does not exist!");
+
+    string line;
+    while (getline(data, line)) {
+      stringstream ss(line);
+      string sender, amount, recipient;
+      if (getline(ss, sender, ',') && getline(ss, amount, ',') && getline(ss, recipient, ',')) {
+        stringstream senderFormat(sender), recipientFormat(recipient);
+        senderFormat >> sender;
+        recipientFormat >> recipient;
+        transactions.push_back({sender, stoll(amount), recipient});
+      }
+    }
+
+    Graph g(inputFilepath);
+    vector<string> addresses = g.BFS();
+
+    cerr << "Loaded " << g.getAddressCount() << " Addresses and "
+         << g.getTransactionCount() << " Transactions \n" << endl;
+
+    if (addresses.empty())
+      throw string("File \"" + inputFilepath + "\" has no transactions!");
+
+    // Fixed seed so every build is timed on the same queries.
+    mt19937_64 generator(0);
+    uniform_int_distribution<size_t> addressDistribution(0, addresses.size() - 1);
+    uniform_int_distribution<size_t> transactionDistribution(0, transactions.size() - 1);
+
+    vector<pair<string, string>> pairs;
+    for (size_t i = 0; i < pairCount; ++i)
+      pairs.emplace_back(addresses[addressDistribution(generator)], addresses[addressDistribution(generator)]);
+
+    vector<size_t> transactionIdxs;
+    for (size_t i = 0; i < 100000; ++i)
+      transactionIdxs.push_back(transactionDistribution(generator));
+
+    vector<BenchmarkResult> results;
+
+    results.push_back(runBenchmark("load_csv", warmup, repetitions, transactions.size(), [&] () {
+      Graph loaded(inputFilepath);
+      sink += loaded.getAddressCount();
+    }));
+
+    results.push_back(runBenchmark("add_transaction", warmup, repetitions, transactions.size(), [&] () {
+      Graph built;
+      for (const Transaction& transaction : transactions)
+        built.addTransaction(transaction.sender, transaction.amount, transaction.recipient);
+      sink += built.getTransactionCount();
+    }));
+
+    // Every address is looked up along with a missing address of similar length.
+    results.push_back(runBenchmark("address_exists", warmup, repetitions, 2 * addresses.size(), [&] () {
+      for (const string& address : addresses) {
+        sink += g.addressExists(address);
+        sink += g.addressExists(address + "x");
+      }
+    }));
+
+    results.push_back(runBenchmark("get_transaction_amount", warmup, repetitions, transactionIdxs.size(), [&] () {
+      for (size_t transactionIdx : transactionIdxs) {
+        const Transaction& transaction = transactions[transactionIdx];
+        sink += g.getTransactionAmount(transaction.sender, transaction.recipient);
+      }
+    }));
+
+    results.push_back(runBenchmark("bfs", warmup, repetitions, g.getAddressCount(), [&] () {
+      sink += g.BFS().size();
+    }));
+
+    results.push_back(runBenchmark("most_likely_path", warmup, repetitions, pairs.size(), [&] () {
+      for (const auto& addressPair : pairs)
+        sink += g.mostLikelyPath(addressPair.first, addressPair.second).size();
+    }));
+
+    results.push_back(runBenchmark("most_likely_paths_batch", warmup, repetitions, pairs.size(), [&] () {
+      for (const Graph::PathWithAmounts& path : g.mostLikelyPaths(pairs))
+        sink += path.addresses.size();
+    }));
+
+    for (size_t samplingSize : {10, 100, 1000}) {
+      if (samplingSize > g.getAddressCount())
+        break;
+
+      results.push_back(runBenchmark("centrality_sampling_" + to_string(samplingSize), warmup, repetitions, samplingSize, [&] () {
+        sink += g.getAddressesByCentrality(samplingSize).size();
+      }));
+    }
+
+    if (outputFilepath.empty()) {
+      writeResults(cout, inputFilepath, g, results);
+    } else {
+      ofstream out(outputFilepath);
+      writeResults(out, inputFilepath, g, results);
+      cout << "Results outputted to " << outputFilepath << endl;
+    }
+  } catch (string e) {
+    cerr << e << endl;
+    return 1;
+  }
+
+  return 0;
+}
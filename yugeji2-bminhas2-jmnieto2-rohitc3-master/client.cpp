@@ -0,0 +1,140 @@
+#include <iostream>
+using std::cin;
+using std::cout;
+using std::cerr;
+using std::endl;
+
+#include <sstream>
+using std::stringstream;
+
+#include <string>
+using std::string;
+using std::getline;
+using std::stoul;
+
+#include <vector>
+using std::vector;
+
+#include <stdexcept>
+
+#include <cctype>
+#include <cstdint>
+
+#include "query.h"
+
+/**
+ * @brief Print usage of client.
+ */
+void printUsage() {
+  cerr << "Usage: ./client <socket> [query]\n\n"
+       << "Queries:\n"
+       << "  exists <address>\n"
+       << "  balance <address>\n"
+       << "  amount <sender> <recipient>\n"
+       << "  path <sender> <recipient>\n"
+       << "  top <k> [sampling size]\n\n"
+       << "Without a query, one query per line is read from standard input." << endl;
+}
+
+/**
+ * @brief Parse whole argument as an unsigned number, unlike stoul 
+ * which ignores trailing characters and wraps negative numbers.
+ *
+ * @param value          Argument to parse.
+ * @param max            Largest number accepted, so it fits its destination.
+ * @return unsigned long Number.
+ * @throws std::invalid_argument if argument is not an unsigned number.
+ * @throws std::out_of_range if number is larger than max.
+ */
+unsigned long parseUnsigned(const string& value, unsigned long max) {
+  if (value.empty() || !isdigit((unsigned char) value[0]))
+    throw std::invalid_argument(value);
+
+  size_t length = 0;
+  unsigned long number = stoul(value, &length);
+  if (length != value.size())
+    throw std::invalid_argument(value);
+  if (number > max)
+    throw std::out_of_range(value);
+
+  return number;
+}
+
+/**
+ * @brief Send query to server and print its answer.
+ *
+ * @param client Connected client.
+ * @param args   Query name followed by its arguments.
+ * @throws string if query is malformed or fails.
+ */
+void runQuery(QueryClient& client, const vector<string>& args) {
+  const string& query = args[0];
+
+  if (query == "exists" && args.size() == 2) {
+    cout << (client.addressExists(args[1]) ? "true" : "false") << endl;
+  } else if (query == "balance" && args.size() == 2) {
+    cout << client.getAddressBalance(args[1]) << endl;
+  } else if (query == "amount" && args.size() == 3) {
+    cout << client.getTransactionAmount(args[1], args[2]) << endl;
+  } else if (query == "path" && args.size() == 3) {
+    vector<string> path = client.mostLikelyPath(args[1], args[2]);
+    for (size_t i = 0; i < path.size(); ++i)
+      cout << (i > 0 ? " " : "") << path[i];
+    cout << endl;
+  } else if (query == "top" && (args.size() == 2 || args.size() == 3)) {
+    // Sent as 32-bit fields, where a truncated k of 0 would ask for every address.
+    uint32_t k = parseUnsigned(args[1], UINT32_MAX);
+    uint32_t samplingSize = args.size() == 3 ? parseUnsigned(args[2], UINT32_MAX) : 0;
+
+    for (const auto& rank : client.getTopCentrality(k, samplingSize))
+      cout << rank.first << " " << rank.second << endl;
+  } else {
+    throw string("Unknown query \"" + query + "\" or wrong number of arguments!");
+  }
+}
+
+int main(int argc, const char * argv[]) {
+  if (argc < 2) {
+    printUsage();
+    return 1;
+  }
+
+  try {
+    QueryClient client(argv[1]);
+
+    if (argc > 2) {
+      runQuery(client, vector<string>(argv + 2, argv + argc));
+      return 0;
+    }
+
+    // Queries from standard input share one connection.
+    string line;
+    while (getline(cin, line)) {
+      stringstream lineStream(line);
+      vector<string> args;
+      string arg;
+      while (lineStream >> arg)
+        args.push_back(arg);
+
+      if (args.empty())
+        continue;
+
+      try {
+        runQuery(client, args);
+      } catch (string e) {
+        cout << "ERROR: " << e << endl;
+      } catch (const std::logic_error&) {
+        // Numbers are invalid or out of range.
+        cout << "ERROR: Invalid number" << endl;
+      }
+    }
+  } catch (string e) {
+    cerr << e << endl;
+    return 1;
+  } catch (const std::logic_error&) {
+    cerr << "Invalid number" << endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,272 @@
+#include "generator.h"
+#include "parallel.h"
+
+#include <math.h>
+
+#include <random>
+using std::poisson_distribution;
+
+#include <string>
+using std::to_string;
+
+// Senders are generated in blocks, each with its own random generator, and
+// blocks are generated in parallel batches so memory stays bounded.
+static const size_t BLOCK_SIZE = 4096;
+static const size_t BATCH_BLOCKS = 64;
+
+// No amount is larger than the 21 million BTC that will ever exist.
+static const long long MAX_AMOUNT = 2100000000000000LL;
+
+static const char* BASE58_ALPHABET = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+/**
+ * Transaction of synthetic graph between address indexes.
+ */
+struct SyntheticTransaction {
+    uint64_t senderIdx;
+    long long amount;
+    uint64_t recipientIdx;
+};
+
+/**
+ * @brief Mix bits of value into a uniformly distributed hash.
+ *
+ * @param x         Value to hash.
+ * @return uint64_t Hash of value, different for every value.
+ */
+static uint64_t _mix(uint64_t x) {
+    // SplitMix64 finalizer.
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Write 33 base58 characters of address after a leading 1.
+ *
+ * @param out        Buffer of at least 34 characters.
+ * @param addressIdx Index of address.
+ *
+ * The first 11 characters encode a bijective hash of the index,
+ * so no two indexes share an address.
+ */
+static void _writeAddress(char* out, uint64_t addressIdx) {
+    out[0] = '1';
+
+    uint64_t hashes[3] = { _mix(addressIdx), _mix(addressIdx ^ 0x5bd1e995ULL), _mix(~addressIdx) };
+    for (size_t h = 0; h < 3; ++h) {
+        uint64_t hash = hashes[h];
+        for (size_t i = 0; i < 11; ++i) {
+            out[1 + h * 11 + i] = BASE58_ALPHABET[hash % 58];
+            hash /= 58;
+        }
+    }
+}
+
+/**
+ * @brief Get indexes of mega-hub addresses.
+ *
+ * @param options         Parameters of graph.
+ * @return vector<uint64_t> Sorted indexes of hubs.
+ */
+static vector<uint64_t> _getHubIdxs(const GeneratorOptions& options) {
+    uint64_t addressCount = 1ULL << options.scale;
+
+    vector<uint64_t> hubIdxs;
+    for (size_t hub = 0; hub < options.hubCount; ++hub)
+        hubIdxs.push_back(_mix(options.seed ^ _mix(hub)) % addressCount);
+
+    sort(hubIdxs.begin(), hubIdxs.end());
+    hubIdxs.erase(unique(hubIdxs.begin(), hubIdxs.end()), hubIdxs.end());
+
+    return hubIdxs;
+}
+
+/**
+ * @brief Generate transactions of every sender in block.
+ *
+ * @param options      Parameters of graph.
+ * @param hubIdxs      Sorted indexes of hubs.
+ * @param block        Index of block of senders.
+ * @param transactions List to fill with transactions of block, ordered by sender.
+ *
+ * R-MAT picks the quadrant of the adjacency matrix bit by bit, so the row
+ * bits of a sender fix its expected number of transactions and each column
+ * bit can be drawn given the row bit. Senders are thereby generated
+ * independently and their duplicate recipients dropped locally.
+ */
+static void _generateBlock(const GeneratorOptions& options, const vector<uint64_t>& hubIdxs,
+                           size_t block, vector<SyntheticTransaction>& transactions) {
+    seed_seq blockSeed = { (unsigned long long) options.seed, (unsigned long long) block };
+    mt19937_64 generator(blockSeed);
+    uniform_real_distribution<double> uniform(0, 1);
+
+    uint64_t addressCount = 1ULL << options.scale;
+    double d = max(0.0, 1 - options.a - options.b - options.c);
+
+    // Probability of a row bit being set, and of a column bit being set given the row bit.
+    double rowOne = options.c + d;
+    double columnOneGivenZero = options.b / max(1e-12, options.a + options.b);
+    double columnOneGivenOne = d / max(1e-12, options.c + d);
+
+    // Column bits are drawn 16 random bits at a time against fixed point thresholds.
+    uint64_t thresholdGivenZero = (uint64_t) (columnOneGivenZero * 65536);
+    uint64_t thresholdGivenOne = (uint64_t) (columnOneGivenOne * 65536);
+
+    double hubFraction = hubIdxs.empty() ? 0 : min(1.0, max(0.0, options.hubFraction));
+    double matrixTransactions = options.transactionCount * (1 - hubFraction);
+    double hubTransactions = options.transactionCount * hubFraction / max<size_t>(1, hubIdxs.size());
+
+    auto drawAmount = [&] () {
+        double amount = options.minAmount * pow(1 - uniform(generator), -1 / options.amountExponent);
+        return (long long) min<double>(amount, MAX_AMOUNT);
+    };
+
+    transactions.clear();
+    vector<uint64_t> recipients;
+
+    uint64_t senderEnd = min<uint64_t>(addressCount, (block + 1) * BLOCK_SIZE);
+    for (uint64_t senderIdx = block * BLOCK_SIZE; senderIdx < senderEnd; ++senderIdx) {
+        size_t rowBits = 0;
+        for (unsigned int bit = 0; bit < options.scale; ++bit)
+            rowBits += (senderIdx >> bit) & 1;
+
+        double expected = matrixTransactions * pow(rowOne, rowBits) * pow(1 - rowOne, options.scale - rowBits);
+        bool hub = binary_search(hubIdxs.begin(), hubIdxs.end(), senderIdx);
+        if (hub)
+            expected += hubTransactions;
+
+        size_t degree = expected > 0 ? poisson_distribution<size_t>(expected)(generator) : 0;
+
+        recipients.clear();
+        for (size_t i = 0; i < degree; ++i) {
+            uint64_t recipientIdx = 0;
+
+            if (hub && uniform(generator) * expected < hubTransactions) {
+                // Hubs pay out to addresses uniformly.
+                recipientIdx = (uint64_t) (uniform(generator) * addressCount);
+            } else if (uniform(generator) < hubFraction) {
+                // Hubs receive from everyone, the first hubs the most.
+                double u = uniform(generator);
+                recipientIdx = hubIdxs[(size_t) (u * u * hubIdxs.size())];
+            } else {
+                uint64_t random = 0;
+                for (unsigned int bit = 0; bit < options.scale; ++bit) {
+                    if (bit % 4 == 0)
+                        random = generator();
+
+                    uint64_t threshold = (senderIdx >> bit) & 1 ? thresholdGivenOne : thresholdGivenZero;
+                    if ((random & 0xffff) < threshold)
+                        recipientIdx |= 1ULL << bit;
+                    random >>= 16;
+                }
+            }
+
+            if (recipientIdx != senderIdx && recipientIdx < addressCount)
+                recipients.push_back(recipientIdx);
+        }
+
+        sort(recipients.begin(), recipients.end());
+        recipients.erase(unique(recipients.begin(), recipients.end()), recipients.end());
+
+        for (uint64_t recipientIdx : recipients)
+            transactions.push_back({ senderIdx, drawAmount(), recipientIdx });
+    }
+}
+
+/**
+ * @brief Generate blocks of graph in parallel batches, handing
+ * the transactions of every block to consumer in block order.
+ *
+ * @param options Parameters of graph.
+ * @param prepare Called as prepare(slot, transactions) in parallel
+ *                after each block is generated.
+ * @param consume Called as consume(slot, transactions) in block order.
+ *
+ * Slot is the position of the block in its batch.
+ */
+template <typename Prepare, typename Consume>
+static void _generateBatches(const GeneratorOptions& options, const Prepare& prepare, const Consume& consume) {
+    if (options.scale >= 64)
+        throw string("Scale of synthetic graph must be less than 64");
+
+    vector<uint64_t> hubIdxs = _getHubIdxs(options);
+    uint64_t addressCount = 1ULL << options.scale;
+    size_t blockCount = (addressCount + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    vector<vector<SyntheticTransaction>> blockTransactions(BATCH_BLOCKS);
+
+    for (size_t firstBlock = 0; firstBlock < blockCount; firstBlock += BATCH_BLOCKS) {
+        size_t lastBlock = min(blockCount, firstBlock + BATCH_BLOCKS);
+
+        parallelForBlocks(firstBlock, lastBlock, [&] (size_t, size_t begin, size_t end) {
+            for (size_t block = begin; block < end; ++block) {
+                _generateBlock(options, hubIdxs, block, blockTransactions[block - firstBlock]);
+                prepare(block - firstBlock, blockTransactions[block - firstBlock]);
+            }
+        }, 1);
+
+        for (size_t block = firstBlock; block < lastBlock; ++block)
+            consume(block - firstBlock, blockTransactions[block - firstBlock]);
+    }
+}
+
+string getSyntheticAddress(uint64_t addressIdx) {
+    char address[34];
+    _writeAddress(address, addressIdx);
+    return string(address, sizeof(address));
+}
+
+size_t writeSyntheticTransactions(const string& filepath, const GeneratorOptions& options) {
+    ofstream file(filepath);
+    if (!file.is_open())
+        throw string("File \"" + filepath + "\" cannot be written!");
+
+    vector<string> blockBuffers(BATCH_BLOCKS);
+    size_t transactionCount = 0;
+
+    // Lines are formatted in parallel and written in order.
+    auto prepare = [&] (size_t slot, const vector<SyntheticTransaction>& transactions) {
+        string& buffer = blockBuffers[slot];
+        buffer.clear();
+
+        char address[34];
+        for (const SyntheticTransaction& transaction : transactions) {
+            _writeAddress(address, transaction.senderIdx);
+            buffer.append(address, sizeof(address));
+            buffer += ',';
+            buffer += to_string(transaction.amount);
+            buffer += ',';
+            _writeAddress(address, transaction.recipientIdx);
+            buffer.append(address, sizeof(address));
+            buffer += '\n';
+        }
+    };
+
+    auto consume = [&] (size_t slot, const vector<SyntheticTransaction>& transactions) {
+        TraceSpan span("write transactions", "output", slot);
+        file << blockBuffers[slot];
+        transactionCount += transactions.size();
+    };
+
+    _generateBatches(options, prepare, consume);
+
+    return transactionCount;
+}
+
+Graph generateSyntheticGraph(const GeneratorOptions& options) {
+    Graph g;
+
+    auto prepare = [] (size_t, const vector<SyntheticTransaction>&) { };
+
+    auto consume = [&] (size_t, const vector<SyntheticTransaction>& transactions) {
+        for (const SyntheticTransaction& transaction : transactions)
+            g.addTransaction(getSyntheticAddress(transaction.senderIdx), transaction.amount,
+                             getSyntheticAddress(transaction.recipientIdx));
+    };
+
+    _generateBatches(options, prepare, consume);
+
+    return g;
+}
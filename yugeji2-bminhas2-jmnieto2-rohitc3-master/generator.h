@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+using std::string;
+
+#include <cstdint>
+
+#include "graph.h"
+
+/**
+ * Parameters of synthetic Bitcoin-like transaction graphs.
+ */
+struct GeneratorOptions {
+    unsigned int scale = 16;             // Graph has up to 2^scale addresses.
+    size_t transactionCount = 1 << 20;   // Transactions generated before duplicates are dropped.
+
+    // R-MAT probabilities of each quadrant, the last being 1 - a - b - c.
+    double a = 0.57;
+    double b = 0.19;
+    double c = 0.19;
+
+    size_t hubCount = 4;                 // Mega-hubs, like exchanges.
+    double hubFraction = 0.05;           // Fraction of transactions sent to and sent by hubs.
+
+    double amountExponent = 1.2;         // Pareto exponent of amounts, smaller is heavier tailed.
+    long long minAmount = 10000;         // Smallest amount in satoshi.
+
+    uint64_t seed = 0;
+};
+
+/**
+ * @brief Get address of synthetic graph, a base58 string shaped
+ * like a legacy Bitcoin address.
+ *
+ * @param addressIdx Index of address.
+ * @return string    Address, different for every index.
+ */
+string getSyntheticAddress(uint64_t addressIdx);
+
+/**
+ * @brief Write synthetic transactions to CSV file in the
+ * sender,amount,recipient format read by Graph.
+ *
+ * @param filepath Path of file to write.
+ * @param options  Parameters of graph.
+ * @return size_t  Number of transactions written.
+ * @throws string if file cannot be opened.
+ *
+ * Senders are generated in parallel blocks seeded by (seed, block), so
+ * output only depends on @a options and not on the number of threads.
+ * Every (sender, recipient) pair appears once.
+ */
+size_t writeSyntheticTransactions(const string& filepath, const GeneratorOptions& options = GeneratorOptions());
+
+/**
+ * @brief Build synthetic graph directly, without writing a file.
+ *
+ * @param options Parameters of graph.
+ * @return Graph  Graph with the transactions writeSyntheticTransactions
+ *                would write, added in the same order.
+ */
+Graph generateSyntheticGraph(const GeneratorOptions& options = GeneratorOptions());
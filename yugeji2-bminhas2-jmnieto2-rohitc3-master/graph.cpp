@@ -1,33 +1,75 @@
 #include "graph.h"
+#include "parallel.h"
+#include "stats.h"
+#include "trace.h"
+
+#include <cstdint>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include <iostream>
 using std::cerr;
 using std::cout;
 using std::endl;
 
+/**
+ * @brief Mix bits of node index into a uniformly distributed hash.
+ * 
+ * @param x         Value to hash.
+ * @return uint64_t Hash of value.
+ */
+static uint64_t _hashNodeIdx(uint64_t x) {
+    // SplitMix64 finalizer.
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+Graph::Graph() { }
+
 Graph::Graph(const string& filepath) {
+    GRAPH_STATS_TIMER(STAT_LOAD);
     ifstream data(filepath);
 
     if (data.is_open()) {
         string line;
 
+        // Lines are traced in chunks so spans stay few.
+        const size_t TRACE_CHUNK_LINES = 1 << 16;
+        size_t lineCount = 0;
+        uint64_t chunkBegin = traceBegin();
+
         while (getline(data, line)) {
-            // Get fields (in order: sender, tx amount, receiver) 
-            // by splitting current line by commas
-            vector<string> fields = _splitString(line);
+            if (++lineCount % TRACE_CHUNK_LINES == 0) {
+                traceEnd("load chunk", "ingest", chunkBegin, lineCount / TRACE_CHUNK_LINES - 1);
+                chunkBegin = traceBegin();
+            }
 
             try {
+                vector<string> fields;
+                long long amount;
+                {
+                    GRAPH_STATS_TIMER(STAT_LOAD_PARSE);
+
+                    // Get fields (in order: sender, tx amount, receiver) 
+                    // by splitting current line by commas
+                    fields = _splitString(line);
+                    amount = stoll(fields.at(1), NULL, 10);
+                }
+
                 const string& senderAddress = fields.at(0);
-                const string& amountStr = fields.at(1);
                 const string& recipientAddress = fields.at(2);
 
-                long long amount = stoll(amountStr, NULL, 10);
-
                 addTransaction(senderAddress, amount, recipientAddress);
             } catch (...) {
                 throw string("Error loading transactions from file \"" + filepath + "\"");
             }
         }
+
+        traceEnd("load chunk", "ingest", chunkBegin, lineCount / TRACE_CHUNK_LINES);
     } else {
         throw string("File \"" + filepath + "\" does not exist!");
     }
@@ -38,9 +80,22 @@ double Graph::convertSatoshiToBTC(long long satoshi) {
 }
 
 void Graph::addTransaction(const string& senderAddress, long long amount, const string& recipientAddress) {
-    size_t senderIdx = _addNode(senderAddress);
-    size_t recipientIdx = _addNode(recipientAddress);
-    _addEdge(senderIdx, amount, recipientIdx);
+    size_t senderIdx, recipientIdx;
+    {
+        GRAPH_STATS_TIMER(STAT_ADD_NODE);
+        senderIdx = _addNode(senderAddress);
+        recipientIdx = _addNode(recipientAddress);
+    }
+    {
+        GRAPH_STATS_TIMER(STAT_ADD_EDGE);
+        _addEdge(senderIdx, amount, recipientIdx);
+    }
+
+    // Indexes no longer describe graph.
+    if (reachability_.built)
+        reachability_ = ReachabilityIndex();
+    if (similarity_.built)
+        similarity_ = SimilarityIndex();
 }
 
 bool Graph::addressExists(const string& address) const {
@@ -69,19 +124,44 @@ long long Graph::getTransactionAmount(const string& senderAddress, const string&
 }
 
 vector<string> Graph::BFS() const {
-    vector<string> addresses;
+    vector<size_t> order;
     vector<bool> visitedNodes(nodes_.size());
+    order.reserve(nodes_.size());
     
     // Run BFS on every component until all nodes have been visited
     for (size_t i = 0; i < nodes_.size(); ++i) {
         if (!visitedNodes[i]) {
-            _BFS(i, addresses, visitedNodes);
+            _BFS(i, order, visitedNodes);
         }
     }
 
+    vector<string> addresses;
+    addresses.reserve(order.size());
+    for (size_t nodeIdx : order)
+        addresses.push_back(nodes_[nodeIdx].address);
+
     return addresses;
 }
 
+size_t Graph::writeBFS(BufferedWriter& writer) const {
+    vector<size_t> order;
+    vector<bool> visitedNodes(nodes_.size());
+
+    // Write every component once traversed so writing overlaps 
+    // traversal when writer has a background thread.
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        if (!visitedNodes[i]) {
+            order.clear();
+            _BFS(i, order, visitedNodes);
+
+            for (size_t nodeIdx : order)
+                writer.writeLine(nodes_[nodeIdx].address);
+        }
+    }
+
+    return nodes_.size();
+}
+
 vector<string> Graph::mostLikelyPath(const string& senderAddress, const string& recipientAddress) const {
     if (!addressExists(senderAddress) || !addressExists(recipientAddress))
         return vector<string>();
@@ -89,197 +169,3330 @@ vector<string> Graph::mostLikelyPath(const string& senderAddress, const string&
     size_t senderIdx = node_dict_.at(senderAddress);
     size_t recipientIdx = node_dict_.at(recipientAddress);
 
-    vector<const Node*> predecessors = _dijkstraSSSP(senderIdx);
+    // Reject impossible pairs before searching when index is available.
+    if (reachability_.built && !_isReachable(senderIdx, recipientIdx))
+        return vector<string>();
+
+    SearchWorkspace workspace;
+    _dijkstraSSSP(senderIdx, workspace);
+
+    PathWithAmounts path;
+    _followPath(recipientIdx, workspace, path);
+
+    return path.addresses;
+}
+
+vector<Graph::PathWithAmounts> Graph::mostLikelyPaths(const vector<pair<string, string>>& queries) const {
+    vector<PathWithAmounts> paths(queries.size());
+
+    // Holds sender and index of every query that may have a path, grouped by sender.
+    vector<pair<size_t, size_t>> senderQueries;
+    vector<size_t> recipientIdxs(queries.size());
+
+    for (size_t queryIdx = 0; queryIdx < queries.size(); ++queryIdx) {
+        const pair<string, string>& query = queries[queryIdx];
+        if (!addressExists(query.first) || !addressExists(query.second))
+            continue;
 
-    vector<string> addressesPath;
-    size_t currentPredecessorIdx = recipientIdx;
+        size_t senderIdx = node_dict_.at(query.first);
+        recipientIdxs[queryIdx] = node_dict_.at(query.second);
 
-    // Follow path from recipient to source.
-    while (predecessors[currentPredecessorIdx]) {
-        const string& currentPredecessorAddress = predecessors[currentPredecessorIdx] -> address;
-        addressesPath.insert(addressesPath.begin(), currentPredecessorAddress);
-        currentPredecessorIdx = predecessors[currentPredecessorIdx] -> index;
+        if (reachability_.built && !_isReachable(senderIdx, recipientIdxs[queryIdx]))
+            continue;
+
+        senderQueries.emplace_back(senderIdx, queryIdx);
     }
 
-    // If path exists then add recipient address to the end of the path.
-    if (!addressesPath.empty())
-        addressesPath.push_back(recipientAddress);
+    sort(senderQueries.begin(), senderQueries.end());
 
-    return addressesPath;
-}
+    // Queries of group g are in [groupBegins[g], groupBegins[g + 1]).
+    vector<size_t> groupBegins;
+    for (size_t i = 0; i < senderQueries.size(); ++i) {
+        if (i == 0 || senderQueries[i].first != senderQueries[i - 1].first)
+            groupBegins.push_back(i);
+    }
+    groupBegins.push_back(senderQueries.size());
 
-vector<pair<string, unsigned int>> Graph::getAddressesByCentrality(size_t samplingSize) const {
-    vector<int> scores = _getBetweenessCentrality(samplingSize);
-    vector<pair<string, unsigned int>> scoresWithAddress;
-    
-    // Build scores with node.
-    for (size_t nodeIdx = 0; nodeIdx < scores.size(); ++nodeIdx) {
-        if (scores[nodeIdx] >= 0) {
-            const Node& node = nodes_[nodeIdx];
-            scoresWithAddress.emplace_back(node.address, scores[nodeIdx]);
+    // Each thread keeps its arrays across the senders it searches.
+    vector<SearchWorkspace> workspaces(getThreadCount());
+
+    parallelForBlocks(0, groupBegins.size() - 1, [&] (size_t threadIdx, size_t blockBegin, size_t blockEnd) {
+        SearchWorkspace& workspace = workspaces[threadIdx];
+
+        for (size_t group = blockBegin; group < blockEnd; ++group) {
+            _dijkstraSSSP(senderQueries[groupBegins[group]].first, workspace);
+
+            for (size_t i = groupBegins[group]; i < groupBegins[group + 1]; ++i) {
+                size_t queryIdx = senderQueries[i].second;
+                _followPath(recipientIdxs[queryIdx], workspace, paths[queryIdx]);
+            }
         }
+    }, 1);
+
+    return paths;
+}
+
+void Graph::buildReachabilityIndex(size_t labelCount) {
+    ReachabilityIndex index;
+    index.labelCount = labelCount;
+
+    size_t componentCount = _getStronglyConnectedComponents(index.component);
+
+    // Collect edges between different components and 
+    // remove duplicates to get edges of condensed DAG.
+    vector<pair<size_t, size_t>> componentEdges;
+    for (const Edge& edge : edges_) {
+        size_t senderComponent = index.component[edge.senderIdx];
+        size_t recipientComponent = index.component[edge.recipientIdx];
+
+        if (senderComponent != recipientComponent)
+            componentEdges.emplace_back(senderComponent, recipientComponent);
     }
 
-    // Comparator for sorting nodes by centrality score.
-    auto comparator = [&] (const pair<string, unsigned int>& lhs, const pair<string, unsigned int>& rhs) {
-        return lhs.second > rhs.second;
-    };
+    sort(componentEdges.begin(), componentEdges.end());
+    componentEdges.erase(unique(componentEdges.begin(), componentEdges.end()), componentEdges.end());
 
-    sort(scoresWithAddress.begin(), scoresWithAddress.end(), comparator);
-    
-    return scoresWithAddress;
-}
+    index.successorOffsets.assign(componentCount + 1, 0);
+    for (const auto& componentEdge : componentEdges)
+        ++index.successorOffsets[componentEdge.first + 1];
 
-long long Graph::getAddressBalance(const string& address) const {
-    if (!addressExists(address))
-        return 0;
-    
-    const Node& node = nodes_[node_dict_.at(address)];
-    long long balance = 0;
-    
-    // Sum transaction amount of all inbound edges
-    for (size_t edgeIdx : node.inbound) {
-        balance += _getEdgeTransactionAmount(edgeIdx);
+    for (size_t c = 0; c < componentCount; ++c)
+        index.successorOffsets[c + 1] += index.successorOffsets[c];
+
+    vector<bool> hasPredecessor(componentCount);
+    for (const auto& componentEdge : componentEdges) {
+        index.successors.push_back(componentEdge.second);
+        hasPredecessor[componentEdge.second] = true;
     }
 
-    // Subtract transaction amount of all outbound edges
-    for (size_t edgeIdx : node.outbound) {
-        balance -= _getEdgeTransactionAmount(edgeIdx);
+    // Components are numbered in reverse topological order, so 
+    // visiting from the highest id visits predecessors first.
+    index.level.assign(componentCount, 0);
+    for (size_t c = componentCount; c-- > 0;) {
+        for (size_t i = index.successorOffsets[c]; i < index.successorOffsets[c + 1]; ++i) {
+            size_t successor = index.successors[i];
+            index.level[successor] = max(index.level[successor], index.level[c] + 1);
+        }
     }
 
-    return balance;
+    vector<size_t> roots;
+    for (size_t c = 0; c < componentCount; ++c) {
+        if (!hasPredecessor[c])
+            roots.push_back(c);
+    }
+
+    index.labelLows.assign(componentCount * labelCount, 0);
+    index.labelHighs.assign(componentCount * labelCount, 0);
+
+    // Fixed seed so the same graph always gets the same index.
+    mt19937 generator(labelCount);
+
+    // Holds component and number of successors visited so far.
+    vector<pair<size_t, size_t>> stack;
+    vector<size_t> firstSuccessor(componentCount);
+    vector<bool> visited(componentCount);
+
+    for (size_t l = 0; l < labelCount; ++l) {
+        // Each label comes from a post-order traversal with roots and 
+        // successors visited in a different random order.
+        shuffle(roots.begin(), roots.end(), generator);
+        visited.assign(componentCount, false);
+        size_t rank = 0;
+
+        for (size_t root : roots) {
+            visited[root] = true;
+            stack.emplace_back(root, 0);
+
+            while (!stack.empty()) {
+                size_t c = stack.back().first;
+                size_t begin = index.successorOffsets[c];
+                size_t degree = index.successorOffsets[c + 1] - begin;
+                size_t labelIdx = c * labelCount + l;
+
+                if (stack.back().second == 0) {
+                    firstSuccessor[c] = degree ? generator() % degree : 0;
+                    index.labelLows[labelIdx] = numeric_limits<size_t>::max();
+                }
+
+                if (stack.back().second < degree) {
+                    size_t offset = (firstSuccessor[c] + stack.back().second++) % degree;
+                    size_t successor = index.successors[begin + offset];
+
+                    if (!visited[successor]) {
+                        visited[successor] = true;
+                        stack.emplace_back(successor, 0);
+                    } else {
+                        size_t successorLow = index.labelLows[successor * labelCount + l];
+                        index.labelLows[labelIdx] = min(index.labelLows[labelIdx], successorLow);
+                    }
+                } else {
+                    // Interval covers the ranks of every component reachable from c.
+                    index.labelHighs[labelIdx] = ++rank;
+                    index.labelLows[labelIdx] = min(index.labelLows[labelIdx], rank);
+                    stack.pop_back();
+
+                    if (!stack.empty()) {
+                        size_t parentLabelIdx = stack.back().first * labelCount + l;
+                        index.labelLows[parentLabelIdx] = min(index.labelLows[parentLabelIdx], index.labelLows[labelIdx]);
+                    }
+                }
+            }
+        }
+    }
+
+    index.built = true;
+    reachability_ = move(index);
 }
 
-size_t Graph::getAddressCount() const {
-    return nodes_.size();
+bool Graph::isReachable(const string& senderAddress, const string& recipientAddress) const {
+    if (!addressExists(senderAddress) || !addressExists(recipientAddress))
+        return false;
+
+    return _isReachable(node_dict_.at(senderAddress), node_dict_.at(recipientAddress));
 }
 
-size_t Graph::getTransactionCount() const {
-    return edges_.size();
+/**
+ * @brief Lower MinHash signature with hashes of value under every 
+ * multiply-add permutation of the 32-bit integers.
+ * 
+ * @param signature Signature to update.
+ * @param factors   Odd multipliers of permutations.
+ * @param offsets   Offsets of permutations.
+ * @param value     Hash of set element.
+ * @param size      Number of values in signature.
+ * 
+ * Loop has no branches or dependencies between 
+ * iterations so the compiler can vectorize it.
+ */
+static void _updateSignature(uint32_t* signature, const uint32_t* factors, const uint32_t* offsets, 
+                             uint32_t value, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        uint32_t hash = factors[i] * value + offsets[i];
+        signature[i] = hash < signature[i] ? hash : signature[i];
+    }
 }
 
-/************************ Private Helper Methods ************************/
+void Graph::buildSimilarityIndex(size_t signatureSize, size_t bandCount) {
+    if (signatureSize == 0 || bandCount == 0 || signatureSize % bandCount != 0)
+        throw string("Signature size must be a positive multiple of band count");
+
+    SimilarityIndex index;
+    index.signatureSize = signatureSize;
+    index.bandCount = bandCount;
+    index.signatures.assign(nodes_.size() * signatureSize, numeric_limits<uint32_t>::max());
+
+    // Fixed permutations so signatures are the same on every build.
+    vector<uint32_t> factors(signatureSize);
+    vector<uint32_t> offsets(signatureSize);
+    for (size_t i = 0; i < signatureSize; ++i) {
+        uint64_t hash = _hashNodeIdx(i);
+        factors[i] = (uint32_t) hash | 1;
+        offsets[i] = (uint32_t) (hash >> 32);
+    }
 
-void Graph::_BFS(size_t startNodeIdx, vector<string>& addresses, vector<bool>& visitedNodes) const {
-    queue<const Node*> q;
+    vector<vector<size_t>> counterparties(getThreadCount());
 
-    visitedNodes[startNodeIdx] = true;
-    q.push(&nodes_[startNodeIdx]);
+    parallelForBlocks(0, nodes_.size(), [&] (size_t threadIdx, size_t blockBegin, size_t blockEnd) {
+        vector<size_t>& nodeCounterparties = counterparties[threadIdx];
 
-    // Push and pop nodes in BFS order through queue 
-    // until all nodes connected to startNode have been visited.
-    while (!q.empty()) {
-        const Node* currentNode = q.front();
-        q.pop();
+        for (size_t nodeIdx = blockBegin; nodeIdx < blockEnd; ++nodeIdx) {
+            const Node& node = nodes_[nodeIdx];
 
-        addresses.push_back(currentNode -> address);
+            // Repeated transactions with the same address count once.
+            nodeCounterparties.clear();
+            for (size_t edgeIdx : node.outbound)
+                nodeCounterparties.push_back(edges_[edgeIdx].recipientIdx);
+            for (size_t edgeIdx : node.inbound)
+                nodeCounterparties.push_back(edges_[edgeIdx].senderIdx);
+
+            sort(nodeCounterparties.begin(), nodeCounterparties.end());
+            nodeCounterparties.erase(unique(nodeCounterparties.begin(), nodeCounterparties.end()), 
+                                     nodeCounterparties.end());
+
+            uint32_t* signature = index.signatures.data() + nodeIdx * signatureSize;
+            for (size_t counterpartyIdx : nodeCounterparties)
+                _updateSignature(signature, factors.data(), offsets.data(), 
+                                 (uint32_t) _hashNodeIdx(counterpartyIdx), signatureSize);
+        }
+    }, 256);
 
-        for (size_t edgeIdx : currentNode -> outbound) {
-            const Edge& edge = edges_[edgeIdx];
-            size_t recipientIdx = edge.recipientIdx;
+    // Swap in signatures first so band keys can be read from them.
+    similarity_ = move(index);
+    similarity_.buckets.resize(bandCount);
 
-            if (!visitedNodes[recipientIdx]) {
-                visitedNodes[recipientIdx] = true;
-                q.push(&nodes_[recipientIdx]);
-            }
+    // Every band is bucketed by its own thread.
+    parallelFor(0, bandCount, [&] (size_t band) {
+        unordered_map<uint64_t, vector<size_t>>& buckets = similarity_.buckets[band];
+
+        for (size_t nodeIdx = 0; nodeIdx < nodes_.size(); ++nodeIdx) {
+            // Addresses without counterparties are similar to nothing.
+            if (nodes_[nodeIdx].outbound.empty() && nodes_[nodeIdx].inbound.empty())
+                continue;
+
+            buckets[_getBandKey(nodeIdx, band)].push_back(nodeIdx);
         }
-    }
+    });
+
+    similarity_.built = true;
 }
 
-vector<const Graph::Node*> Graph::_dijkstraSSSP(size_t sourceNodeIdx) const {
+vector<pair<string, double>> Graph::getSimilarAddresses(const string& address, size_t k) const {
+    if (!similarity_.built)
+        throw string("Similarity index is not built");
 
-    // Holds distance from nodeIdx to source node.
-    vector<double> distance(nodes_.size(), numeric_limits<double>::max());
+    auto it = node_dict_.find(address);
+    if (it == node_dict_.end() || k == 0)
+        return vector<pair<string, double>>();
 
-    // Holds predecessor from nodeIdx in path to get to source node.
-    vector<const Node*> predecessor(nodes_.size());
+    size_t nodeIdx = it -> second;
 
-    // Comparator to get closest node in distance from priority queue.
-    auto comparator = [&] (size_t lhsIdx, size_t rhsIdx) {
-        return distance[lhsIdx] > distance[rhsIdx];
+    // Collect nodes sharing a bucket with node in any band.
+    vector<size_t> candidates;
+    for (size_t band = 0; band < similarity_.bandCount; ++band) {
+        const unordered_map<uint64_t, vector<size_t>>& buckets = similarity_.buckets[band];
+
+        auto bucket = buckets.find(_getBandKey(nodeIdx, band));
+        if (bucket == buckets.end())
+            continue;
+
+        for (size_t candidateIdx : bucket -> second) {
+            if (candidateIdx != nodeIdx)
+                candidates.push_back(candidateIdx);
+        }
+    }
+
+    sort(candidates.begin(), candidates.end());
+    candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+
+    vector<pair<size_t, double>> similarNodes;
+    for (size_t candidateIdx : candidates)
+        similarNodes.emplace_back(candidateIdx, _estimateSimilarity(nodeIdx, candidateIdx));
+
+    // Comparator for ordering nodes by similarity, ties broken by index.
+    auto comparator = [&] (const pair<size_t, double>& lhs, const pair<size_t, double>& rhs) {
+        return lhs.second > rhs.second || (lhs.second == rhs.second && lhs.first < rhs.first);
     };
 
-    priority_queue<size_t, vector<size_t>, decltype(comparator)> q(comparator);
-    
-    distance[sourceNodeIdx] = 0;
-    q.push(sourceNodeIdx);
-    
-    // Loop until every node reachable from source has been assigned 
-    // a predecessor node in the shortest path to the source node.
-    while (!q.empty()) {
-        size_t currentNodeIdx = q.top();
-        const Node& currentNode = nodes_[currentNodeIdx];
-        q.pop();
+    k = min(k, similarNodes.size());
+    partial_sort(similarNodes.begin(), similarNodes.begin() + k, similarNodes.end(), comparator);
 
-        for (size_t edgeIdx : currentNode.outbound) {
-            const Edge& edge = edges_[edgeIdx];
-            size_t recipientIdx = edge.recipientIdx;
+    vector<pair<string, double>> similarAddresses;
+    for (size_t i = 0; i < k; ++i)
+        similarAddresses.emplace_back(nodes_[similarNodes[i].first].address, similarNodes[i].second);
 
-            if (distance[currentNodeIdx] + edge.weight < distance[recipientIdx]) {
-                distance[recipientIdx] = distance[currentNodeIdx] + edge.weight;
-                predecessor[recipientIdx] = &currentNode;
-                q.push(recipientIdx);
+    return similarAddresses;
+}
+
+vector<pair<pair<string, string>, double>> Graph::getSimilarAddressPairs(double threshold, size_t maxBucketSize) const {
+    if (!similarity_.built)
+        throw string("Similarity index is not built");
+
+    size_t rowCount = similarity_.signatureSize / similarity_.bandCount;
+    vector<vector<pair<pair<size_t, size_t>, double>>> threadPairs(getThreadCount());
+
+    parallelForBlocks(0, similarity_.bandCount, [&] (size_t threadIdx, size_t blockBegin, size_t blockEnd) {
+        for (size_t band = blockBegin; band < blockEnd; ++band) {
+            for (const auto& bucket : similarity_.buckets[band]) {
+                const vector<size_t>& bucketNodes = bucket.second;
+                if (maxBucketSize > 0 && bucketNodes.size() > maxBucketSize)
+                    continue;
+
+                for (size_t i = 0; i < bucketNodes.size(); ++i) {
+                    for (size_t j = i + 1; j < bucketNodes.size(); ++j) {
+                        const uint32_t* lhs = similarity_.signatures.data() + bucketNodes[i] * similarity_.signatureSize;
+                        const uint32_t* rhs = similarity_.signatures.data() + bucketNodes[j] * similarity_.signatureSize;
+
+                        // Pair is only generated by the first band its rows agree on and 
+                        // whose bucket is not skipped, so no pair is reported twice 
+                        // without collecting them all.
+                        bool seenEarlier = false;
+                        for (size_t earlierBand = 0; earlierBand < band && !seenEarlier; ++earlierBand) {
+                            seenEarlier = equal(lhs + earlierBand * rowCount, lhs + (earlierBand + 1) * rowCount, 
+                                                rhs + earlierBand * rowCount);
+
+                            // Agreeing rows put both nodes in the same bucket of that band.
+                            if (seenEarlier && maxBucketSize > 0)
+                                seenEarlier = similarity_.buckets[earlierBand].at(_getBandKey(bucketNodes[i], earlierBand)).size() <= maxBucketSize;
+                        }
+
+                        // Keys of a band can collide without its rows agreeing.
+                        if (seenEarlier || !equal(lhs + band * rowCount, lhs + (band + 1) * rowCount, rhs + band * rowCount))
+                            continue;
+
+                        double similarity = _estimateSimilarity(bucketNodes[i], bucketNodes[j]);
+                        if (similarity >= threshold)
+                            threadPairs[threadIdx].push_back({{bucketNodes[i], bucketNodes[j]}, similarity});
+                    }
+                }
             }
         }
+    }, 1);
+
+    vector<pair<pair<string, string>, double>> similarPairs;
+    for (const auto& pairs : threadPairs) {
+        for (const auto& similarPair : pairs) {
+            const string& lhsAddress = nodes_[similarPair.first.first].address;
+            const string& rhsAddress = nodes_[similarPair.first.second].address;
+
+            if (lhsAddress < rhsAddress)
+                similarPairs.push_back({{lhsAddress, rhsAddress}, similarPair.second});
+            else
+                similarPairs.push_back({{rhsAddress, lhsAddress}, similarPair.second});
+        }
     }
 
-    return predecessor;
-}  
+    // Comparator for ordering pairs by similarity, ties broken by addresses.
+    auto comparator = [&] (const pair<pair<string, string>, double>& lhs, const pair<pair<string, string>, double>& rhs) {
+        return lhs.second > rhs.second || (lhs.second == rhs.second && lhs.first < rhs.first);
+    };
 
-vector<int> Graph::_getBetweenessCentrality(size_t samplingSize) const {
-    if (samplingSize == 0 || samplingSize > nodes_.size())
-        samplingSize = nodes_.size();
+    sort(similarPairs.begin(), similarPairs.end(), comparator);
 
-    // Centrality score of all nodes with a default score of -1 
-    // to indicate nodes not visited.
-    vector<int> score(nodes_.size(), -1);
+    return similarPairs;
+}
 
-    // Assign node indexes to vector to use for sampling.
-    vector<size_t> nodeIdxs;
-    for (size_t i = 0; i < nodes_.size(); ++i)
-        nodeIdxs.push_back(i);
-    
-    random_shuffle(nodeIdxs.begin(), nodeIdxs.end());
+vector<pair<string, unsigned int>> Graph::getAddressesByCentrality(size_t samplingSize) const {
+    Ranking ranking = getCentralityRanking(samplingSize);
+    vector<pair<string, unsigned int>> scoresWithAddress;
+    scoresWithAddress.reserve(ranking.size());
 
-    for (size_t u = 0; u < samplingSize; ++u) {
-        size_t sourceIdx = nodeIdxs[u];
+    // Addresses are copied once, after sorting.
+    for (size_t rank = 0; rank < ranking.size(); ++rank)
+        scoresWithAddress.emplace_back(ranking.getAddress(rank), (unsigned int) ranking.getScore(rank));
 
-        // Indicate node has been visited by offsetting default -1 score.
-        ++score[sourceIdx];
-        
-        // Get all the paths through predecessors list 
-        // of all nodes from source node.
-        vector<const Node*> predecessors = _dijkstraSSSP(sourceIdx);
-        
-        for (size_t recipientIdx = 0; recipientIdx < predecessors.size(); ++recipientIdx) {
-            const Node*& predecessor = predecessors[recipientIdx];
-            if (predecessor) {
-                size_t currentPredecessorIdx = predecessor -> index;
+    return scoresWithAddress;
+}
 
-                while (currentPredecessorIdx != sourceIdx) {
-                    // Predecessor is detected as node in between path of
-                    // source and recipient, so centrality is increased.
-                    ++score[currentPredecessorIdx];
-                    currentPredecessorIdx = predecessors[currentPredecessorIdx] -> index;
-                }
-            }
+Graph::Ranking Graph::getCentralityRanking(size_t samplingSize, size_t k) const {
+    vector<int> scores = _getBetweenessCentrality(samplingSize);
+
+    // Nodes not visited keep a score of -1 and are left out.
+    return _rankNodes(vector<double>(scores.begin(), scores.end()), k);
+}
+
+size_t Graph::Ranking::size() const {
+    return nodeIdxs_.size();
+}
+
+const string& Graph::Ranking::getAddress(size_t rank) const {
+    return graph_ -> nodes_[nodeIdxs_[rank]].address;
+}
+
+double Graph::Ranking::getScore(size_t rank) const {
+    return scores_[rank];
+}
+
+void Graph::Ranking::write(BufferedWriter& writer) const {
+    for (size_t nodeIdx : nodeIdxs_)
+        writer.writeLine(graph_ -> nodes_[nodeIdx].address);
+}
+
+vector<pair<string, double>> Graph::getAddressesByPageRank(double dampingFactor, double tolerance, size_t maxIterations) const {
+    return _rankAddresses(_getPageRank(dampingFactor, tolerance, maxIterations));
+}
+
+vector<pair<string, double>> Graph::getAddressesByHarmonicCentrality(unsigned int registerBits, size_t maxDistance) const {
+    vector<double> harmonic, closeness;
+    _hyperBall(registerBits, maxDistance, harmonic, closeness);
+
+    return _rankAddresses(harmonic);
+}
+
+vector<pair<string, double>> Graph::getAddressesByClosenessCentrality(unsigned int registerBits, size_t maxDistance) const {
+    vector<double> harmonic, closeness;
+    _hyperBall(registerBits, maxDistance, harmonic, closeness);
+
+    return _rankAddresses(closeness);
+}
+
+Graph::DistanceCentralities Graph::getAddressesByDistanceCentrality(unsigned int registerBits, size_t maxDistance) const {
+    vector<double> harmonic, closeness;
+    _hyperBall(registerBits, maxDistance, harmonic, closeness);
+
+    DistanceCentralities centralities;
+    centralities.harmonic = _rankAddresses(harmonic);
+    centralities.closeness = _rankAddresses(closeness);
+    return centralities;
+}
+
+vector<double> Graph::getNeighborhoodFunction(unsigned int registerBits, size_t maxDistance) const {
+    vector<double> harmonic, closeness;
+    return _hyperBall(registerBits, maxDistance, harmonic, closeness);
+}
+
+vector<pair<string, unsigned int>> Graph::getAddressesByCoreness() const {
+    vector<size_t> coreness = _getCoreness();
+    vector<pair<string, unsigned int>> corenessWithAddress;
+
+    for (size_t nodeIdx = 0; nodeIdx < coreness.size(); ++nodeIdx)
+        corenessWithAddress.emplace_back(nodes_[nodeIdx].address, coreness[nodeIdx]);
+
+    // Comparator for sorting nodes by coreness.
+    auto comparator = [&] (const pair<string, unsigned int>& lhs, const pair<string, unsigned int>& rhs) {
+        return lhs.second > rhs.second;
+    };
+
+    stable_sort(corenessWithAddress.begin(), corenessWithAddress.end(), comparator);
+
+    return corenessWithAddress;
+}
+
+Graph Graph::getCore(unsigned int k) const {
+    vector<size_t> coreness = _getCoreness();
+    Graph core;
+
+    for (size_t edgeIdx = 0; edgeIdx < edges_.size(); ++edgeIdx) {
+        const Edge& edge = edges_[edgeIdx];
+
+        if (coreness[edge.senderIdx] >= k && coreness[edge.recipientIdx] >= k) {
+            core.addTransaction(nodes_[edge.senderIdx].address, 
+                                _getEdgeTransactionAmount(edgeIdx), 
+                                nodes_[edge.recipientIdx].address);
         }
     }
-  
-    return score;
+
+    return core;
 }
 
-long long Graph::_getEdgeTransactionAmount(size_t edgeIdx) const {
-    const Edge& edge = edges_[edgeIdx];
+vector<Graph::DenseSubgraph> Graph::getDenseSubgraphs(size_t count, bool weighted, double epsilon, bool batchPeeling) const {
+    vector<size_t> offsets, neighbors;
+    vector<double> weights;
 
-    // Edge weight is stored as 1/(transaction amount)
-    // convert back to original transaction amount.
-    return llround(1.0 / edge.weight);
+    if (weighted) {
+        _getUndirectedAdjacency(offsets, neighbors, &weights);
+    } else {
+        _getUndirectedAdjacency(offsets, neighbors);
+        weights.assign(neighbors.size(), 1);
+    }
+
+    vector<DenseSubgraph> subgraphs;
+    vector<char> excluded(nodes_.size(), 0);
+    vector<size_t> members;
+
+    for (size_t i = 0; i < count; ++i) {
+        double density = _getDensestSubgraph(offsets, neighbors, weights, excluded, epsilon, batchPeeling, members);
+        if (density <= 0)
+            break;
+
+        DenseSubgraph subgraph;
+        subgraph.density = density;
+        for (size_t nodeIdx : members) {
+            subgraph.addresses.push_back(nodes_[nodeIdx].address);
+            excluded[nodeIdx] = 1;
+        }
+
+        subgraphs.push_back(move(subgraph));
+    }
+
+    return subgraphs;
 }
 
-size_t Graph::_addNode(const string& address) {
-    if (addressExists(address))
-        return node_dict_.at(address);
+vector<pair<string, size_t>> Graph::getCommunitiesByLouvain(size_t maxLevels) const {
+    return _listCommunities(_getLouvainCommunities(maxLevels));
+}
+
+vector<pair<string, size_t>> Graph::getCommunitiesByLabelPropagation(size_t maxIterations) const {
+    return _listCommunities(_getLabelPropagationCommunities(maxIterations));
+}
+
+Graph::CycleCounts Graph::getCycleCounts() const {
+    vector<CycleCounts> nodeCounts;
+    return _countCycles(nodeCounts);
+}
+
+vector<pair<string, Graph::CycleCounts>> Graph::getAddressesByCycleCount() const {
+    vector<CycleCounts> nodeCounts;
+    _countCycles(nodeCounts);
+
+    vector<pair<string, CycleCounts>> countsWithAddress;
+    for (size_t nodeIdx = 0; nodeIdx < nodeCounts.size(); ++nodeIdx) {
+        const CycleCounts& counts = nodeCounts[nodeIdx];
+        if (counts.twoCycles || counts.threeCycles || counts.triangles)
+            countsWithAddress.emplace_back(nodes_[nodeIdx].address, counts);
+    }
+
+    // Comparator for sorting nodes by cycles, then by triangles.
+    auto comparator = [&] (const pair<string, CycleCounts>& lhs, const pair<string, CycleCounts>& rhs) {
+        size_t lhsCycles = lhs.second.twoCycles + lhs.second.threeCycles;
+        size_t rhsCycles = rhs.second.twoCycles + rhs.second.threeCycles;
+        return lhsCycles > rhsCycles || (lhsCycles == rhsCycles && lhs.second.triangles > rhs.second.triangles);
+    };
+
+    stable_sort(countsWithAddress.begin(), countsWithAddress.end(), comparator);
+
+    return countsWithAddress;
+}
+
+vector<pair<string, double>> Graph::getAddressesByTaint(const vector<string>& blacklist, size_t hopLimit, double threshold) const {
+    vector<size_t> seedIdxs;
+    for (const string& address : blacklist) {
+        auto it = node_dict_.find(address);
+        if (it != node_dict_.end())
+            seedIdxs.push_back(it -> second);
+    }
+
+    vector<double> taint = _getTaint(seedIdxs, hopLimit, threshold);
+    vector<pair<string, double>> taintWithAddress;
+
+    for (size_t nodeIdx = 0; nodeIdx < taint.size(); ++nodeIdx) {
+        if (taint[nodeIdx] > 0)
+            taintWithAddress.emplace_back(nodes_[nodeIdx].address, taint[nodeIdx]);
+    }
+
+    // Comparator for sorting nodes by taint.
+    auto comparator = [&] (const pair<string, double>& lhs, const pair<string, double>& rhs) {
+        return lhs.second > rhs.second;
+    };
+
+    stable_sort(taintWithAddress.begin(), taintWithAddress.end(), comparator);
+
+    return taintWithAddress;
+}
+
+vector<pair<string, Graph::NearestLabel>> Graph::getNearestLabeledAddresses(const vector<string>& labeledAddresses, 
+                                                                          bool towardLabels) const {
+    vector<size_t> sourceIdxs;
+    for (const string& address : labeledAddresses) {
+        auto it = node_dict_.find(address);
+        if (it != node_dict_.end())
+            sourceIdxs.push_back(it -> second);
+    }
+
+    vector<double> distance;
+    vector<size_t> nearestSource;
+    _multiSourceDijkstra(sourceIdxs, towardLabels, distance, nearestSource);
+
+    vector<pair<string, NearestLabel>> nearestLabels;
+    for (size_t nodeIdx = 0; nodeIdx < nodes_.size(); ++nodeIdx) {
+        if (nearestSource[nodeIdx] == nodes_.size())
+            continue;
+
+        NearestLabel nearest;
+        nearest.labeledAddress = nodes_[nearestSource[nodeIdx]].address;
+        nearest.cost = distance[nodeIdx];
+        nearestLabels.emplace_back(nodes_[nodeIdx].address, nearest);
+    }
+
+    // Comparator for sorting nodes by cost of path to their nearest label.
+    auto comparator = [&] (const pair<string, NearestLabel>& lhs, const pair<string, NearestLabel>& rhs) {
+        return lhs.second.cost < rhs.second.cost;
+    };
+
+    stable_sort(nearestLabels.begin(), nearestLabels.end(), comparator);
+
+    return nearestLabels;
+}
+
+Graph::MaxFlow Graph::getMaxFlow(const string& senderAddress, const string& recipientAddress, size_t hopLimit) const {
+    MaxFlow maxFlow;
+
+    if (!addressExists(senderAddress) || !addressExists(recipientAddress) || senderAddress == recipientAddress)
+        return maxFlow;
+
+    vector<size_t> cutEdgeIdxs;
+    maxFlow.flow = _pushRelabel(node_dict_.at(senderAddress), node_dict_.at(recipientAddress), hopLimit, cutEdgeIdxs);
+
+    for (size_t edgeIdx : cutEdgeIdxs) {
+        const Edge& edge = edges_[edgeIdx];
+        maxFlow.cutTransactions.emplace_back(nodes_[edge.senderIdx].address, nodes_[edge.recipientIdx].address);
+    }
+
+    return maxFlow;
+}
+
+vector<Graph::PeelChain> Graph::getPeelChains(size_t minLength, long long minAmount, double dominanceRatio) const {
+    size_t nodeCount = nodes_.size();
+
+    vector<long long> forwardedAmounts;
+    vector<long long> peeledAmounts;
+    vector<size_t> next = _getDominantRecipients(dominanceRatio, forwardedAmounts, peeledAmounts);
+
+    // Transactions and peeled amount of chain from each node, memoized 
+    // so the chain through a node is only followed once.
+    vector<size_t> tailLength(nodeCount, 0);
+    vector<long long> tailPeeled(nodeCount, 0);
+    vector<char> state(nodeCount, 0); // 0 unvisited, 1 on current walk, 2 done.
+    vector<size_t> walk;
+
+    for (size_t startIdx = 0; startIdx < nodeCount; ++startIdx) {
+        // Follow chain until it ends, reaches a finished node or loops.
+        size_t nodeIdx = startIdx;
+        while (nodeIdx != nodeCount && state[nodeIdx] == 0) {
+            state[nodeIdx] = 1;
+            walk.push_back(nodeIdx);
+            nodeIdx = next[nodeIdx];
+        }
+
+        // Every address in loop is followed once before a chain stops.
+        if (nodeIdx != nodeCount && state[nodeIdx] == 1) {
+            size_t loopBegin = find(walk.begin(), walk.end(), nodeIdx) - walk.begin();
+            long long loopPeeled = 0;
+            for (size_t i = loopBegin; i < walk.size(); ++i)
+                loopPeeled += peeledAmounts[walk[i]];
+
+            for (size_t i = loopBegin; i < walk.size(); ++i) {
+                tailLength[walk[i]] = walk.size() - loopBegin - 1;
+                tailPeeled[walk[i]] = loopPeeled;
+                state[walk[i]] = 2;
+            }
+
+            walk.resize(loopBegin);
+        }
+
+        while (!walk.empty()) {
+            size_t currentIdx = walk.back();
+            walk.pop_back();
+
+            if (next[currentIdx] != nodeCount) {
+                tailLength[currentIdx] = tailLength[next[currentIdx]] + 1;
+                tailPeeled[currentIdx] = tailPeeled[next[currentIdx]] + peeledAmounts[currentIdx];
+            }
+            state[currentIdx] = 2;
+        }
+    }
+
+    // Chains start at nodes that are not the dominant recipient of any node.
+    vector<char> continued(nodeCount, 0);
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx) {
+        if (next[nodeIdx] != nodeCount)
+            continued[next[nodeIdx]] = 1;
+    }
+
+    vector<size_t> headIdxs;
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx) {
+        if (!continued[nodeIdx] && tailLength[nodeIdx] > 0 && tailLength[nodeIdx] >= minLength 
+            && forwardedAmounts[nodeIdx] >= minAmount)
+            headIdxs.push_back(nodeIdx);
+    }
+
+    vector<PeelChain> chains(headIdxs.size());
+    parallelFor(0, headIdxs.size(), [&] (size_t i) {
+        size_t nodeIdx = headIdxs[i];
+        PeelChain& chain = chains[i];
+
+        chain.amount = forwardedAmounts[nodeIdx];
+        chain.peeledAmount = tailPeeled[nodeIdx];
+        chain.addresses.push_back(nodes_[nodeIdx].address);
+
+        for (size_t hop = tailLength[nodeIdx]; hop > 0; --hop) {
+            nodeIdx = next[nodeIdx];
+            chain.addresses.push_back(nodes_[nodeIdx].address);
+        }
+    });
+
+    // Comparator for sorting chains by length, then by amount.
+    auto comparator = [&] (const PeelChain& lhs, const PeelChain& rhs) {
+        if (lhs.addresses.size() != rhs.addresses.size())
+            return lhs.addresses.size() > rhs.addresses.size();
+        return lhs.amount > rhs.amount;
+    };
+
+    stable_sort(chains.begin(), chains.end(), comparator);
+
+    return chains;
+}
+
+Graph::SatoshiFlow Graph::simulateSatoshiFlow(const string& senderAddress, const string& recipientAddress, 
+                                              size_t walkCount, size_t maxSteps, size_t pathCount, 
+                                              unsigned long long seed) const {
+    // Walks in the same chunk share a random stream seeded by chunk number.
+    const size_t CHUNK_SIZE = 1024;
+
+    SatoshiFlow flow;
+    if (!addressExists(senderAddress) || !addressExists(recipientAddress) || walkCount == 0)
+        return flow;
+
+    size_t senderIdx = node_dict_.at(senderAddress);
+    size_t recipientIdx = node_dict_.at(recipientAddress);
+
+    steady_clock::time_point start = steady_clock::now();
+
+    AliasTable table;
+    _buildAliasTable(table);
+
+    size_t threadCount = getThreadCount();
+    vector<size_t> threadReached(threadCount);
+    vector<map<vector<size_t>, size_t>> threadPaths(threadCount);
+
+    parallelForBlocks(0, walkCount, [&] (size_t threadIdx, size_t begin, size_t end) {
+        seed_seq chunkSeed = { (unsigned long long) seed, (unsigned long long) (begin / CHUNK_SIZE) };
+        mt19937_64 generator(chunkSeed);
+        vector<size_t> path;
+
+        for (size_t walk = begin; walk < end; ++walk) {
+            size_t currentIdx = senderIdx;
+            path.assign(1, senderIdx);
+
+            for (size_t step = 0; step < maxSteps && currentIdx != recipientIdx; ++step) {
+                currentIdx = _sampleOutbound(table, currentIdx, generator);
+                if (currentIdx == nodes_.size())
+                    break;
+
+                // Erase loop when walk comes back to a node already on the path.
+                auto previousVisit = find(path.begin(), path.end(), currentIdx);
+                if (previousVisit != path.end())
+                    path.erase(previousVisit + 1, path.end());
+                else
+                    path.push_back(currentIdx);
+            }
+
+            if (currentIdx == recipientIdx) {
+                ++threadReached[threadIdx];
+                ++threadPaths[threadIdx][path];
+            }
+        }
+    }, CHUNK_SIZE);
+
+    size_t reached = 0;
+    map<vector<size_t>, size_t> pathFrequency;
+    for (size_t threadIdx = 0; threadIdx < threadCount; ++threadIdx) {
+        reached += threadReached[threadIdx];
+        for (const auto& path : threadPaths[threadIdx])
+            pathFrequency[path.first] += path.second;
+    }
+
+    vector<pair<vector<size_t>, size_t>> paths(pathFrequency.begin(), pathFrequency.end());
+
+    // Comparator for ordering paths by frequency, ties broken by path.
+    auto comparator = [&] (const pair<vector<size_t>, size_t>& lhs, const pair<vector<size_t>, size_t>& rhs) {
+        return lhs.second > rhs.second || (lhs.second == rhs.second && lhs.first < rhs.first);
+    };
+
+    pathCount = min(pathCount, paths.size());
+    partial_sort(paths.begin(), paths.begin() + pathCount, paths.end(), comparator);
+
+    for (size_t i = 0; i < pathCount; ++i) {
+        vector<string> addressesPath;
+        for (size_t nodeIdx : paths[i].first)
+            addressesPath.push_back(nodes_[nodeIdx].address);
+
+        flow.paths.emplace_back(addressesPath, (double) paths[i].second / reached);
+    }
+
+    duration<double> elapsed = steady_clock::now() - start;
+
+    flow.reachProbability = (double) reached / walkCount;
+    flow.walksPerSecond = walkCount / max(elapsed.count(), 1e-9);
+
+    return flow;
+}
+
+size_t Graph::writeRandomWalks(const string& filepath, size_t walksPerAddress, size_t walkLength, 
+                               double p, double q, bool binary, unsigned long long seed) const {
+    // Walks are generated in parallel batches of blocks of start nodes and 
+    // written in order, so memory stays bounded and output is reproducible.
+    const size_t BLOCK_SIZE = 256;
+    const size_t BATCH_BLOCKS = 256;
+
+    // Non-positive parameters have no valid bias, and rejection sampling would never accept.
+    if (!(p > 0) || !(q > 0))
+        throw string("Parameters p and q of random walks must be positive!");
+
+    ofstream file(filepath, binary ? std::ios::binary : std::ios::out);
+    if (!file.is_open())
+        throw string("File \"" + filepath + "\" cannot be written!");
+
+    if (binary) {
+        ofstream vocabulary(filepath + ".vocab");
+        if (!vocabulary.is_open())
+            throw string("File \"" + filepath + ".vocab\" cannot be written!");
+
+        for (const Node& node : nodes_)
+            vocabulary << node.address << "\n";
+    }
+
+    AliasTable table;
+    _buildAliasTable(table);
+
+    // Second order bias needs to know if a candidate neighbors the previous node.
+    bool biased = p != 1 || q != 1;
+    vector<size_t> offsets, neighbors;
+    if (biased)
+        _getUndirectedAdjacency(offsets, neighbors);
+
+    double maxBias = max(1.0, max(1 / p, 1 / q));
+    size_t nodeCount = nodes_.size();
+    size_t blockCount = (nodeCount + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    size_t totalSteps = 0;
+
+    vector<string> blockBuffers(BATCH_BLOCKS);
+    vector<size_t> blockSteps(BATCH_BLOCKS);
+
+    for (size_t round = 0; round < walksPerAddress; ++round) {
+        for (size_t firstBlock = 0; firstBlock < blockCount; firstBlock += BATCH_BLOCKS) {
+            size_t lastBlock = min(blockCount, firstBlock + BATCH_BLOCKS);
+
+            parallelFor(firstBlock, lastBlock, [&] (size_t block) {
+                seed_seq blockSeed = { (unsigned long long) seed, (unsigned long long) round, (unsigned long long) block };
+                mt19937_64 generator(blockSeed);
+                uniform_real_distribution<double> uniform(0, 1);
+
+                string& buffer = blockBuffers[block - firstBlock];
+                size_t& steps = blockSteps[block - firstBlock];
+                buffer.clear();
+                steps = 0;
+
+                vector<uint32_t> walk;
+                size_t blockEnd = min(nodeCount, (block + 1) * BLOCK_SIZE);
+
+                for (size_t startIdx = block * BLOCK_SIZE; startIdx < blockEnd; ++startIdx) {
+                    walk.assign(1, startIdx);
+
+                    while (walk.size() < walkLength) {
+                        size_t currentIdx = walk.back();
+                        size_t nextIdx = _sampleOutbound(table, currentIdx, generator);
+                        if (nextIdx == nodeCount)
+                            break;
+
+                        if (biased && walk.size() > 1) {
+                            // Accept candidate with probability of its bias over the largest bias.
+                            size_t previousIdx = walk[walk.size() - 2];
+                            while (true) {
+                                double bias = 1 / q;
+                                if (nextIdx == previousIdx)
+                                    bias = 1 / p;
+                                else if (binary_search(neighbors.begin() + offsets[previousIdx], 
+                                                       neighbors.begin() + offsets[previousIdx + 1], nextIdx))
+                                    bias = 1;
+
+                                if (uniform(generator) * maxBias < bias)
+                                    break;
+
+                                nextIdx = _sampleOutbound(table, currentIdx, generator);
+                            }
+                        }
+
+                        walk.push_back(nextIdx);
+                    }
+
+                    steps += walk.size();
+
+                    if (binary) {
+                        uint32_t length = walk.size();
+                        buffer.append((const char*) &length, sizeof(length));
+                        buffer.append((const char*) walk.data(), walk.size() * sizeof(uint32_t));
+                    } else {
+                        for (size_t i = 0; i < walk.size(); ++i) {
+                            if (i)
+                                buffer += ' ';
+                            buffer += nodes_[walk[i]].address;
+                        }
+                        buffer += '\n';
+                    }
+                }
+            });
+
+            for (size_t block = firstBlock; block < lastBlock; ++block) {
+                TraceSpan span("write walks", "output", block);
+                file.write(blockBuffers[block - firstBlock].data(), blockBuffers[block - firstBlock].size());
+                totalSteps += blockSteps[block - firstBlock];
+            }
+        }
+    }
+
+    return totalSteps;
+}
+
+vector<pair<string, double>> Graph::getExposedAddresses(const vector<string>& seedAddresses, size_t k, 
+                                                        double residualThreshold, double teleportProbability) const {
+    // Rank would be pushed around cycles forever without a threshold above zero, 
+    // or without any rank stopping at each push.
+    if (!(residualThreshold > 0))
+        throw string("Residual threshold of exposure must be positive!");
+    if (!(teleportProbability > 0) || teleportProbability > 1)
+        throw string("Teleport probability of exposure must be in (0, 1]!");
+
+    vector<size_t> seedIdxs;
+    for (const string& address : seedAddresses) {
+        auto it = node_dict_.find(address);
+        if (it != node_dict_.end())
+            seedIdxs.push_back(it -> second);
+    }
+
+    if (seedIdxs.empty() || k == 0)
+        return vector<pair<string, double>>();
+
+    // Only touched nodes are stored so cost follows the pushed neighborhood.
+    unordered_map<size_t, double> exposure;
+    unordered_map<size_t, double> residual;
+    unordered_set<size_t> queued;
+    queue<size_t> q;
+
+    for (size_t seedIdx : seedIdxs) {
+        residual[seedIdx] += 1.0 / seedIdxs.size();
+        if (queued.insert(seedIdx).second)
+            q.push(seedIdx);
+    }
+
+    // Push residual of queued nodes along outbound edges until 
+    // every residual is below threshold relative to its degree.
+    while (!q.empty()) {
+        size_t currentIdx = q.front();
+        q.pop();
+        queued.erase(currentIdx);
+
+        const Node& currentNode = nodes_[currentIdx];
+        double currentResidual = residual[currentIdx];
+        residual[currentIdx] = 0;
+
+        double outboundAmount = 0;
+        for (size_t edgeIdx : currentNode.outbound)
+            outboundAmount += _getEdgeTransactionAmount(edgeIdx);
+
+        // Funds stay at addresses that never send them on.
+        if (outboundAmount <= 0) {
+            exposure[currentIdx] += currentResidual;
+            continue;
+        }
+
+        exposure[currentIdx] += teleportProbability * currentResidual;
+        double pushedResidual = (1 - teleportProbability) * currentResidual;
+
+        for (size_t edgeIdx : currentNode.outbound) {
+            size_t recipientIdx = edges_[edgeIdx].recipientIdx;
+            double& recipientResidual = residual[recipientIdx];
+            recipientResidual += pushedResidual * _getEdgeTransactionAmount(edgeIdx) / outboundAmount;
+
+            size_t recipientDegree = max<size_t>(1, nodes_[recipientIdx].outbound.size());
+            if (recipientResidual >= residualThreshold * recipientDegree && queued.insert(recipientIdx).second)
+                q.push(recipientIdx);
+        }
+    }
+
+    for (size_t seedIdx : seedIdxs)
+        exposure.erase(seedIdx);
+
+    vector<pair<size_t, double>> exposedNodes(exposure.begin(), exposure.end());
+
+    // Comparator for ordering nodes by exposure, ties broken by index 
+    // so results do not depend on hash table order.
+    auto comparator = [&] (const pair<size_t, double>& lhs, const pair<size_t, double>& rhs) {
+        return lhs.second > rhs.second || (lhs.second == rhs.second && lhs.first < rhs.first);
+    };
+
+    k = min(k, exposedNodes.size());
+    partial_sort(exposedNodes.begin(), exposedNodes.begin() + k, exposedNodes.end(), comparator);
+
+    vector<pair<string, double>> exposedAddresses;
+    for (size_t i = 0; i < k; ++i)
+        exposedAddresses.emplace_back(nodes_[exposedNodes[i].first].address, exposedNodes[i].second);
+
+    return exposedAddresses;
+}
+
+long long Graph::getAddressBalance(const string& address) const {
+    if (!addressExists(address))
+        return 0;
+    
+    const Node& node = nodes_[node_dict_.at(address)];
+    long long balance = 0;
+    
+    // Sum transaction amount of all inbound edges
+    for (size_t edgeIdx : node.inbound) {
+        balance += _getEdgeTransactionAmount(edgeIdx);
+    }
+
+    // Subtract transaction amount of all outbound edges
+    for (size_t edgeIdx : node.outbound) {
+        balance -= _getEdgeTransactionAmount(edgeIdx);
+    }
+
+    return balance;
+}
+
+size_t Graph::getAddressCount() const {
+    return nodes_.size();
+}
+
+size_t Graph::getTransactionCount() const {
+    return edges_.size();
+}
+
+/**
+ * @brief Get heap bytes held by string.
+ * 
+ * @param str     String.
+ * @return size_t Capacity and terminator, 0 if stored inline.
+ */
+static size_t _getStringHeapBytes(const string& str) {
+    const char* data = str.data();
+    const char* object = (const char*) &str;
+
+    // Short strings are stored inside the string object itself.
+    if (data >= object && data < object + sizeof(string))
+        return 0;
+
+    return str.capacity() + 1;
+}
+
+/**
+ * @brief Add heap memory held by vector to entry.
+ * 
+ * @param entry Entry to add to.
+ * @param v     Vector.
+ */
+template <typename T>
+static void _addVectorUsage(Graph::MemoryUsageEntry& entry, const vector<T>& v) {
+    if (v.capacity() == 0)
+        return;
+
+    entry.bytes += v.capacity() * sizeof(T);
+    entry.slackBytes += (v.capacity() - v.size()) * sizeof(T);
+    ++entry.allocations;
+}
+
+Graph::MemoryUsage Graph::memoryUsage() const {
+    MemoryUsageEntry nodes, edges, buckets, entries, addresses, outbounds, inbounds, reachability, similarity;
+    nodes.name = "nodes_";
+    edges.name = "edges_";
+    buckets.name = "node_dict_ buckets";
+    entries.name = "node_dict_ entries";
+    addresses.name = "address strings";
+    outbounds.name = "outbound vectors";
+    inbounds.name = "inbound vectors";
+    reachability.name = "reachability index";
+    similarity.name = "similarity index";
+
+    _addVectorUsage(nodes, nodes_);
+    _addVectorUsage(edges, edges_);
+
+    for (const Node& node : nodes_) {
+        _addVectorUsage(outbounds, node.outbound);
+        _addVectorUsage(inbounds, node.inbound);
+
+        size_t stringBytes = _getStringHeapBytes(node.address);
+        addresses.bytes += stringBytes;
+        addresses.allocations += stringBytes > 0;
+    }
+
+    // A table with a single bucket keeps it inline.
+    if (node_dict_.bucket_count() > 1) {
+        buckets.bytes = node_dict_.bucket_count() * sizeof(void*);
+        buckets.allocations = 1;
+    }
+
+    // Every entry is allocated with a next pointer and cached hash.
+    entries.bytes = node_dict_.size() * (sizeof(void*) + sizeof(size_t) + sizeof(pair<const string, size_t>));
+    entries.allocations = node_dict_.size();
+
+    // Keys are a second copy of every address.
+    for (const auto& entry : node_dict_) {
+        size_t stringBytes = _getStringHeapBytes(entry.first);
+        addresses.bytes += stringBytes;
+        addresses.allocations += stringBytes > 0;
+    }
+
+    _addVectorUsage(reachability, reachability_.component);
+    _addVectorUsage(reachability, reachability_.level);
+    _addVectorUsage(reachability, reachability_.successorOffsets);
+    _addVectorUsage(reachability, reachability_.successors);
+    _addVectorUsage(reachability, reachability_.labelLows);
+    _addVectorUsage(reachability, reachability_.labelHighs);
+
+    _addVectorUsage(similarity, similarity_.signatures);
+    _addVectorUsage(similarity, similarity_.buckets);
+    for (const auto& bandBuckets : similarity_.buckets) {
+        if (bandBuckets.bucket_count() > 1) {
+            similarity.bytes += bandBuckets.bucket_count() * sizeof(void*);
+            ++similarity.allocations;
+        }
+
+        similarity.bytes += bandBuckets.size() * (sizeof(void*) + sizeof(size_t) + sizeof(pair<const uint64_t, vector<size_t>>));
+        similarity.allocations += bandBuckets.size();
+
+        for (const auto& bucket : bandBuckets)
+            _addVectorUsage(similarity, bucket.second);
+    }
+
+    MemoryUsage usage;
+    usage.entries = { nodes, edges, buckets, entries, addresses, outbounds, inbounds, reachability, similarity };
+
+    for (const MemoryUsageEntry& entry : usage.entries) {
+        usage.bytes += entry.bytes;
+        usage.allocations += entry.allocations;
+        usage.slackBytes += entry.slackBytes;
+    }
+
+    return usage;
+}
+
+/************************ Private Helper Methods ************************/
+
+void Graph::_BFS(size_t startNodeIdx, vector<size_t>& order, vector<bool>& visitedNodes) const {
+    // Nodes leave the queue in the order they enter it, so the 
+    // order itself is the queue, from head to its end.
+    size_t head = order.size();
+
+    visitedNodes[startNodeIdx] = true;
+    order.push_back(startNodeIdx);
+
+    // Current level ends where the queue ended when it began.
+    size_t level = 0;
+    size_t levelEnd = order.size();
+    uint64_t levelBegin = traceBegin();
+
+    // Pop nodes in BFS order until all nodes 
+    // connected to startNode have been visited.
+    while (head < order.size()) {
+        const Node& currentNode = nodes_[order[head++]];
+
+        for (size_t edgeIdx : currentNode.outbound) {
+            const Edge& edge = edges_[edgeIdx];
+            size_t recipientIdx = edge.recipientIdx;
+
+            if (!visitedNodes[recipientIdx]) {
+                visitedNodes[recipientIdx] = true;
+                order.push_back(recipientIdx);
+            }
+        }
+
+        if (head == levelEnd) {
+            traceEnd("BFS level", "bfs", levelBegin, level++);
+            levelEnd = order.size();
+            levelBegin = traceBegin();
+        }
+    }
+}
+
+void Graph::_followPath(size_t recipientIdx, const SearchWorkspace& workspace, PathWithAmounts& path) const {
+    GRAPH_STATS_TIMER(STAT_PATH_RECONSTRUCTION);
+
+    // Follow path from recipient to source, then reverse it.
+    size_t currentIdx = recipientIdx;
+    while (workspace.predecessorEdge[currentIdx] != edges_.size()) {
+        size_t edgeIdx = workspace.predecessorEdge[currentIdx];
+        path.addresses.push_back(nodes_[currentIdx].address);
+        path.amounts.push_back(_getEdgeTransactionAmount(edgeIdx));
+        path.totalAmount += path.amounts.back();
+        currentIdx = edges_[edgeIdx].senderIdx;
+    }
+
+    // If path exists then add source address to the start of the path.
+    if (!path.addresses.empty())
+        path.addresses.push_back(nodes_[currentIdx].address);
+
+    reverse(path.addresses.begin(), path.addresses.end());
+    reverse(path.amounts.begin(), path.amounts.end());
+}
+
+vector<const Graph::Node*> Graph::_dijkstraSSSP(size_t sourceNodeIdx) const {
+    SearchWorkspace workspace;
+    _dijkstraSSSP(sourceNodeIdx, workspace);
+
+    // Holds predecessor from nodeIdx in path to get to source node.
+    vector<const Node*> predecessor(nodes_.size());
+    for (size_t nodeIdx : workspace.reached) {
+        size_t edgeIdx = workspace.predecessorEdge[nodeIdx];
+        if (edgeIdx != edges_.size())
+            predecessor[nodeIdx] = &nodes_[edges_[edgeIdx].senderIdx];
+    }
+
+    return predecessor;
+}
+
+void Graph::_dijkstraSSSP(size_t sourceNodeIdx, SearchWorkspace& workspace) const {
+    GRAPH_STATS_TIMER(STAT_DIJKSTRA);
+
+    vector<double>& distance = workspace.distance;
+    vector<size_t>& predecessorEdge = workspace.predecessorEdge;
+
+    // Only nodes reached by the last search need to be reset.
+    if (distance.size() != nodes_.size()) {
+        distance.assign(nodes_.size(), numeric_limits<double>::max());
+        predecessorEdge.assign(nodes_.size(), edges_.size());
+    } else {
+        for (size_t nodeIdx : workspace.reached) {
+            distance[nodeIdx] = numeric_limits<double>::max();
+            predecessorEdge[nodeIdx] = edges_.size();
+        }
+    }
+    workspace.reached.clear();
+
+    // Comparator to get closest node in distance from heap.
+    auto comparator = [&] (size_t lhsIdx, size_t rhsIdx) {
+        return distance[lhsIdx] > distance[rhsIdx];
+    };
+
+    vector<size_t>& q = workspace.queue;
+    q.clear();
+
+    distance[sourceNodeIdx] = 0;
+    workspace.reached.push_back(sourceNodeIdx);
+    q.push_back(sourceNodeIdx);
+    GRAPH_STATS_INCREMENT(STAT_DIJKSTRA_PUSHES);
+    
+    // Loop until every node reachable from source has been assigned 
+    // a predecessor edge in the shortest path to the source node.
+    while (!q.empty()) {
+        pop_heap(q.begin(), q.end(), comparator);
+        size_t currentNodeIdx = q.back();
+        const Node& currentNode = nodes_[currentNodeIdx];
+        q.pop_back();
+        GRAPH_STATS_INCREMENT(STAT_DIJKSTRA_POPS);
+
+        for (size_t edgeIdx : currentNode.outbound) {
+            const Edge& edge = edges_[edgeIdx];
+            size_t recipientIdx = edge.recipientIdx;
+
+            if (distance[currentNodeIdx] + edge.weight < distance[recipientIdx]) {
+                if (distance[recipientIdx] == numeric_limits<double>::max())
+                    workspace.reached.push_back(recipientIdx);
+
+                distance[recipientIdx] = distance[currentNodeIdx] + edge.weight;
+                predecessorEdge[recipientIdx] = edgeIdx;
+                q.push_back(recipientIdx);
+                push_heap(q.begin(), q.end(), comparator);
+                GRAPH_STATS_INCREMENT(STAT_DIJKSTRA_RELAXATIONS);
+                GRAPH_STATS_INCREMENT(STAT_DIJKSTRA_PUSHES);
+            }
+        }
+    }
+}  
+
+void Graph::_multiSourceDijkstra(const vector<size_t>& sourceIdxs, bool reverse, 
+                                 vector<double>& distance, vector<size_t>& nearestSource) const {
+    GRAPH_STATS_TIMER(STAT_DIJKSTRA);
+    distance.assign(nodes_.size(), numeric_limits<double>::max());
+    nearestSource.assign(nodes_.size(), nodes_.size());
+
+    // Queue holds (distance, node) so entries made stale by a 
+    // shorter path are recognized and skipped when popped.
+    priority_queue<pair<double, size_t>, vector<pair<double, size_t>>, greater<pair<double, size_t>>> q;
+
+    for (size_t sourceIdx : sourceIdxs) {
+        if (nearestSource[sourceIdx] != nodes_.size())
+            continue;
+
+        distance[sourceIdx] = 0;
+        nearestSource[sourceIdx] = sourceIdx;
+        q.emplace(0, sourceIdx);
+        GRAPH_STATS_INCREMENT(STAT_DIJKSTRA_PUSHES);
+    }
+
+    // Every node is settled once, by whichever source reaches it first.
+    while (!q.empty()) {
+        double currentDistance = q.top().first;
+        size_t currentNodeIdx = q.top().second;
+        q.pop();
+        GRAPH_STATS_INCREMENT(STAT_DIJKSTRA_POPS);
+
+        if (currentDistance > distance[currentNodeIdx])
+            continue;
+
+        const Node& currentNode = nodes_[currentNodeIdx];
+        const vector<size_t>& edgeIdxs = reverse ? currentNode.inbound : currentNode.outbound;
+
+        for (size_t edgeIdx : edgeIdxs) {
+            const Edge& edge = edges_[edgeIdx];
+            size_t neighborIdx = reverse ? edge.senderIdx : edge.recipientIdx;
+
+            if (currentDistance + edge.weight < distance[neighborIdx]) {
+                distance[neighborIdx] = currentDistance + edge.weight;
+                nearestSource[neighborIdx] = nearestSource[currentNodeIdx];
+                q.emplace(distance[neighborIdx], neighborIdx);
+                GRAPH_STATS_INCREMENT(STAT_DIJKSTRA_RELAXATIONS);
+                GRAPH_STATS_INCREMENT(STAT_DIJKSTRA_PUSHES);
+            }
+        }
+    }
+}
+
+vector<size_t> Graph::_getDominantRecipients(double dominanceRatio, vector<long long>& forwardedAmounts, 
+                                             vector<long long>& peeledAmounts) const {
+    vector<size_t> next(nodes_.size(), nodes_.size());
+    forwardedAmounts.assign(nodes_.size(), 0);
+    peeledAmounts.assign(nodes_.size(), 0);
+
+    parallelFor(0, nodes_.size(), [&] (size_t nodeIdx) {
+        long long outboundAmount = 0;
+        long long dominantAmount = 0;
+        size_t dominantEdgeIdx = edges_.size();
+
+        for (size_t edgeIdx : nodes_[nodeIdx].outbound) {
+            long long amount = _getEdgeTransactionAmount(edgeIdx);
+            outboundAmount += amount;
+
+            if (amount > dominantAmount) {
+                dominantAmount = amount;
+                dominantEdgeIdx = edgeIdx;
+            }
+        }
+
+        if (dominantEdgeIdx != edges_.size() && dominantAmount >= dominanceRatio * outboundAmount) {
+            next[nodeIdx] = edges_[dominantEdgeIdx].recipientIdx;
+            forwardedAmounts[nodeIdx] = dominantAmount;
+            peeledAmounts[nodeIdx] = outboundAmount - dominantAmount;
+        }
+    });
+
+    return next;
+}
+
+unordered_map<size_t, size_t> Graph::_getHopDistances(size_t startIdx, bool reverse, size_t hopLimit) const {
+    unordered_map<size_t, size_t> hops;
+    queue<size_t> q;
+
+    hops[startIdx] = 0;
+    q.push(startIdx);
+
+    while (!q.empty()) {
+        size_t currentIdx = q.front();
+        q.pop();
+
+        size_t currentHops = hops[currentIdx];
+        if (hopLimit > 0 && currentHops == hopLimit)
+            continue;
+
+        const Node& currentNode = nodes_[currentIdx];
+        for (size_t edgeIdx : reverse ? currentNode.inbound : currentNode.outbound) {
+            size_t neighborIdx = reverse ? edges_[edgeIdx].senderIdx : edges_[edgeIdx].recipientIdx;
+
+            if (hops.emplace(neighborIdx, currentHops + 1).second)
+                q.push(neighborIdx);
+        }
+    }
+
+    return hops;
+}
+
+long long Graph::_pushRelabel(size_t sourceIdx, size_t sinkIdx, size_t hopLimit, vector<size_t>& cutEdgeIdxs) const {
+    unordered_map<size_t, size_t> sourceHops = _getHopDistances(sourceIdx, false, hopLimit);
+    unordered_map<size_t, size_t> sinkHops = _getHopDistances(sinkIdx, true, hopLimit);
+
+    // Only nodes on a path from source to sink within hop limit can carry flow.
+    vector<size_t> members;
+    unordered_map<size_t, size_t> localIdx;
+    for (const auto& hops : sourceHops) {
+        auto it = sinkHops.find(hops.first);
+        if (it != sinkHops.end() && (hopLimit == 0 || hops.second + it -> second <= hopLimit)) {
+            localIdx[hops.first] = members.size();
+            members.push_back(hops.first);
+        }
+    }
+
+    if (!localIdx.count(sinkIdx))
+        return 0;
+
+    size_t n = members.size();
+    size_t source = localIdx[sourceIdx];
+    size_t sink = localIdx[sinkIdx];
+
+    // Residual graph, every edge has a forward arc with its amount 
+    // as capacity and a reverse arc starting with no capacity.
+    vector<size_t> offsets(n + 1, 0);
+    for (size_t v = 0; v < n; ++v) {
+        for (size_t edgeIdx : nodes_[members[v]].outbound) {
+            auto it = localIdx.find(edges_[edgeIdx].recipientIdx);
+            if (it != localIdx.end()) {
+                ++offsets[v + 1];
+                ++offsets[it -> second + 1];
+            }
+        }
+    }
+
+    for (size_t v = 0; v < n; ++v)
+        offsets[v + 1] += offsets[v];
+
+    size_t arcCount = offsets[n];
+    vector<size_t> heads(arcCount);
+    vector<size_t> reverseArcs(arcCount);
+    vector<long long> capacities(arcCount, 0);
+
+    // Edge of each forward arc, size of edges_ list for reverse arcs.
+    vector<size_t> arcEdgeIdxs(arcCount, edges_.size());
+
+    vector<size_t> nextArc(offsets.begin(), offsets.end() - 1);
+    for (size_t v = 0; v < n; ++v) {
+        for (size_t edgeIdx : nodes_[members[v]].outbound) {
+            auto it = localIdx.find(edges_[edgeIdx].recipientIdx);
+            if (it == localIdx.end())
+                continue;
+
+            size_t w = it -> second;
+            size_t forwardArc = nextArc[v]++;
+            size_t reverseArc = nextArc[w]++;
+
+            heads[forwardArc] = w;
+            heads[reverseArc] = v;
+            reverseArcs[forwardArc] = reverseArc;
+            reverseArcs[reverseArc] = forwardArc;
+            capacities[forwardArc] = _getEdgeTransactionAmount(edgeIdx);
+            arcEdgeIdxs[forwardArc] = edgeIdx;
+        }
+    }
+
+    // Heights of n mark nodes that cannot reach sink.
+    vector<size_t> height(n, n);
+    vector<size_t> heightCount(n + 1, 0);
+    vector<long long> excess(n, 0);
+    vector<size_t> currentArc(offsets.begin(), offsets.end() - 1);
+
+    // Set heights to exact distances to sink in residual graph.
+    auto globalRelabel = [&] () {
+        height.assign(n, n);
+        height[sink] = 0;
+
+        queue<size_t> q;
+        q.push(sink);
+
+        while (!q.empty()) {
+            size_t w = q.front();
+            q.pop();
+
+            for (size_t arc = offsets[w]; arc < offsets[w + 1]; ++arc) {
+                size_t v = heads[arc];
+                if (height[v] == n && v != source && capacities[reverseArcs[arc]] > 0) {
+                    height[v] = height[w] + 1;
+                    q.push(v);
+                }
+            }
+        }
+
+        heightCount.assign(n + 1, 0);
+        for (size_t v = 0; v < n; ++v)
+            ++heightCount[height[v]];
+
+        copy(offsets.begin(), offsets.end() - 1, currentArc.begin());
+    };
+
+    // Saturate every arc out of source.
+    for (size_t arc = offsets[source]; arc < offsets[source + 1]; ++arc) {
+        long long capacity = capacities[arc];
+        capacities[arc] = 0;
+        capacities[reverseArcs[arc]] += capacity;
+        excess[heads[arc]] += capacity;
+        excess[source] -= capacity;
+    }
+
+    globalRelabel();
+
+    queue<size_t> active;
+    for (size_t v = 0; v < n; ++v) {
+        if (v != source && v != sink && excess[v] > 0)
+            active.push(v);
+    }
+
+    // Work between global relabels, as arcs scanned while relabeling.
+    size_t relabelWork = 0;
+    size_t globalRelabelWork = 6 * n + arcCount;
+
+    while (!active.empty()) {
+        size_t v = active.front();
+        active.pop();
+
+        // Discharge node until its excess is gone or it cannot reach sink.
+        while (excess[v] > 0 && height[v] < n) {
+            if (currentArc[v] == offsets[v + 1]) {
+                size_t oldHeight = height[v];
+                size_t newHeight = n;
+                for (size_t arc = offsets[v]; arc < offsets[v + 1]; ++arc) {
+                    if (capacities[arc] > 0)
+                        newHeight = min(newHeight, height[heads[arc]] + 1);
+                }
+
+                --heightCount[oldHeight];
+                height[v] = newHeight;
+                ++heightCount[newHeight];
+                currentArc[v] = offsets[v];
+                relabelWork += offsets[v + 1] - offsets[v] + 1;
+
+                // Gap heuristic, with no node left at old height 
+                // nodes above it cannot reach sink either.
+                if (heightCount[oldHeight] == 0) {
+                    for (size_t u = 0; u < n; ++u) {
+                        if (height[u] > oldHeight && height[u] < n) {
+                            --heightCount[height[u]];
+                            height[u] = n;
+                            ++heightCount[n];
+                        }
+                    }
+                }
+
+                continue;
+            }
+
+            size_t arc = currentArc[v];
+            size_t w = heads[arc];
+
+            if (capacities[arc] > 0 && height[v] == height[w] + 1) {
+                long long pushed = min(excess[v], capacities[arc]);
+                capacities[arc] -= pushed;
+                capacities[reverseArcs[arc]] += pushed;
+                excess[v] -= pushed;
+
+                if (excess[w] == 0 && w != source && w != sink)
+                    active.push(w);
+                excess[w] += pushed;
+            } else {
+                ++currentArc[v];
+            }
+        }
+
+        if (relabelWork > globalRelabelWork) {
+            globalRelabel();
+            relabelWork = 0;
+        }
+    }
+
+    // Nodes that can still reach sink form the sink side of the 
+    // minimum cut, forward arcs into it from the rest are saturated.
+    globalRelabel();
+
+    for (size_t v = 0; v < n; ++v) {
+        if (height[v] < n)
+            continue;
+
+        for (size_t arc = offsets[v]; arc < offsets[v + 1]; ++arc) {
+            if (arcEdgeIdxs[arc] != edges_.size() && height[heads[arc]] < n)
+                cutEdgeIdxs.push_back(arcEdgeIdxs[arc]);
+        }
+    }
+
+    sort(cutEdgeIdxs.begin(), cutEdgeIdxs.end());
+
+    return excess[sink];
+}
+
+bool Graph::_isReachable(size_t senderIdx, size_t recipientIdx) const {
+    if (senderIdx == recipientIdx)
+        return true;
+
+    // Without index fall back to searching outbound edges from sender.
+    if (!reachability_.built) {
+        vector<bool> visitedNodes(nodes_.size());
+        vector<size_t> stack = { senderIdx };
+        visitedNodes[senderIdx] = true;
+
+        while (!stack.empty()) {
+            const Node& currentNode = nodes_[stack.back()];
+            stack.pop_back();
+
+            for (size_t edgeIdx : currentNode.outbound) {
+                size_t nextIdx = edges_[edgeIdx].recipientIdx;
+                if (nextIdx == recipientIdx)
+                    return true;
+
+                if (!visitedNodes[nextIdx]) {
+                    visitedNodes[nextIdx] = true;
+                    stack.push_back(nextIdx);
+                }
+            }
+        }
+
+        return false;
+    }
+
+    size_t senderComponent = reachability_.component[senderIdx];
+    size_t recipientComponent = reachability_.component[recipientIdx];
+
+    if (senderComponent == recipientComponent)
+        return true;
+
+    if (!_reachabilityLabelsAllow(senderComponent, recipientComponent))
+        return false;
+
+    // Labels cannot confirm reachability, so search condensed DAG 
+    // only through components whose labels still allow a path.
+    vector<size_t> stack = { senderComponent };
+    unordered_set<size_t> visitedComponents = { senderComponent };
+
+    while (!stack.empty()) {
+        size_t c = stack.back();
+        stack.pop_back();
+
+        for (size_t i = reachability_.successorOffsets[c]; i < reachability_.successorOffsets[c + 1]; ++i) {
+            size_t successor = reachability_.successors[i];
+            if (successor == recipientComponent)
+                return true;
+
+            if (_reachabilityLabelsAllow(successor, recipientComponent) && visitedComponents.insert(successor).second)
+                stack.push_back(successor);
+        }
+    }
+
+    return false;
+}
+
+bool Graph::_reachabilityLabelsAllow(size_t senderComponent, size_t recipientComponent) const {
+    const ReachabilityIndex& index = reachability_;
+
+    // Successors always have smaller ids and deeper levels.
+    if (senderComponent < recipientComponent || index.level[senderComponent] >= index.level[recipientComponent])
+        return false;
+
+    // Recipient interval must be nested in sender interval for every label.
+    for (size_t l = 0; l < index.labelCount; ++l) {
+        size_t senderLabelIdx = senderComponent * index.labelCount + l;
+        size_t recipientLabelIdx = recipientComponent * index.labelCount + l;
+
+        if (index.labelLows[recipientLabelIdx] < index.labelLows[senderLabelIdx] || 
+            index.labelHighs[recipientLabelIdx] > index.labelHighs[senderLabelIdx])
+            return false;
+    }
+
+    return true;
+}
+
+size_t Graph::_getStronglyConnectedComponents(vector<size_t>& component) const {
+    const size_t UNVISITED = numeric_limits<size_t>::max();
+
+    vector<size_t> order(nodes_.size(), UNVISITED);
+    vector<size_t> lowLink(nodes_.size());
+    vector<bool> onStack(nodes_.size());
+    vector<size_t> componentStack;
+
+    // Holds node and number of outbound edges visited so far.
+    vector<pair<size_t, size_t>> callStack;
+
+    component.assign(nodes_.size(), 0);
+    size_t counter = 0;
+    size_t componentCount = 0;
+
+    for (size_t startIdx = 0; startIdx < nodes_.size(); ++startIdx) {
+        if (order[startIdx] != UNVISITED)
+            continue;
+
+        order[startIdx] = lowLink[startIdx] = counter++;
+        componentStack.push_back(startIdx);
+        onStack[startIdx] = true;
+        callStack.emplace_back(startIdx, 0);
+
+        while (!callStack.empty()) {
+            size_t currentIdx = callStack.back().first;
+            const vector<size_t>& outbound = nodes_[currentIdx].outbound;
+
+            if (callStack.back().second < outbound.size()) {
+                size_t recipientIdx = edges_[outbound[callStack.back().second++]].recipientIdx;
+
+                if (order[recipientIdx] == UNVISITED) {
+                    order[recipientIdx] = lowLink[recipientIdx] = counter++;
+                    componentStack.push_back(recipientIdx);
+                    onStack[recipientIdx] = true;
+                    callStack.emplace_back(recipientIdx, 0);
+                } else if (onStack[recipientIdx]) {
+                    lowLink[currentIdx] = min(lowLink[currentIdx], order[recipientIdx]);
+                }
+            } else {
+                callStack.pop_back();
+
+                if (!callStack.empty()) {
+                    size_t parentIdx = callStack.back().first;
+                    lowLink[parentIdx] = min(lowLink[parentIdx], lowLink[currentIdx]);
+                }
+
+                // Node is root of its component, so pop the whole component.
+                if (lowLink[currentIdx] == order[currentIdx]) {
+                    size_t memberIdx;
+                    do {
+                        memberIdx = componentStack.back();
+                        componentStack.pop_back();
+                        onStack[memberIdx] = false;
+                        component[memberIdx] = componentCount;
+                    } while (memberIdx != currentIdx);
+
+                    ++componentCount;
+                }
+            }
+        }
+    }
+
+    return componentCount;
+}
+
+uint64_t Graph::_getBandKey(size_t nodeIdx, size_t band) const {
+    size_t rowCount = similarity_.signatureSize / similarity_.bandCount;
+    const uint32_t* rows = similarity_.signatures.data() + nodeIdx * similarity_.signatureSize + band * rowCount;
+
+    uint64_t key = band;
+    for (size_t row = 0; row < rowCount; ++row)
+        key = _hashNodeIdx(key ^ rows[row]);
+
+    return key;
+}
+
+double Graph::_estimateSimilarity(size_t lhsIdx, size_t rhsIdx) const {
+    const uint32_t* lhs = similarity_.signatures.data() + lhsIdx * similarity_.signatureSize;
+    const uint32_t* rhs = similarity_.signatures.data() + rhsIdx * similarity_.signatureSize;
+
+    size_t agreeing = 0;
+    for (size_t i = 0; i < similarity_.signatureSize; ++i)
+        agreeing += lhs[i] == rhs[i];
+
+    return (double) agreeing / similarity_.signatureSize;
+}
+
+vector<int> Graph::_getBetweenessCentrality(size_t samplingSize) const {
+    GRAPH_STATS_TIMER(STAT_CENTRALITY);
+    if (samplingSize == 0 || samplingSize > nodes_.size())
+        samplingSize = nodes_.size();
+
+    // Centrality score of all nodes with a default score of -1 
+    // to indicate nodes not visited.
+    vector<int> score(nodes_.size(), -1);
+
+    // Assign node indexes to vector to use for sampling.
+    vector<size_t> nodeIdxs;
+    for (size_t i = 0; i < nodes_.size(); ++i)
+        nodeIdxs.push_back(i);
+    
+    random_shuffle(nodeIdxs.begin(), nodeIdxs.end());
+
+    for (size_t u = 0; u < samplingSize; ++u) {
+        size_t sourceIdx = nodeIdxs[u];
+        TraceSpan span("centrality source", "centrality", sourceIdx);
+
+        // Indicate node has been visited by offsetting default -1 score.
+        ++score[sourceIdx];
+        GRAPH_STATS_INCREMENT(STAT_CENTRALITY_SOURCES);
+        
+        // Get all the paths through predecessors list 
+        // of all nodes from source node.
+        vector<const Node*> predecessors = _dijkstraSSSP(sourceIdx);
+        
+        for (size_t recipientIdx = 0; recipientIdx < predecessors.size(); ++recipientIdx) {
+            const Node*& predecessor = predecessors[recipientIdx];
+            if (predecessor) {
+                size_t currentPredecessorIdx = predecessor -> index;
+
+                while (currentPredecessorIdx != sourceIdx) {
+                    // Predecessor is detected as node in between path of
+                    // source and recipient, so centrality is increased.
+                    ++score[currentPredecessorIdx];
+                    currentPredecessorIdx = predecessors[currentPredecessorIdx] -> index;
+                }
+            }
+        }
+    }
+  
+    return score;
+}
+
+vector<double> Graph::_getPageRank(double dampingFactor, double tolerance, size_t maxIterations) const {
+    size_t nodeCount = nodes_.size();
+    if (nodeCount == 0)
+        return vector<double>();
+
+    // Total amount sent by each node, used to split its rank over outbound edges.
+    vector<double> outboundAmount(nodeCount);
+    parallelFor(0, nodeCount, [&] (size_t nodeIdx) {
+        for (size_t edgeIdx : nodes_[nodeIdx].outbound)
+            outboundAmount[nodeIdx] += _getEdgeTransactionAmount(edgeIdx);
+    });
+
+    // Each iteration streams through flat inbound arrays instead of edges_.
+    vector<size_t> inboundOffsets, inboundSenders;
+    vector<double> inboundAmounts;
+    _getInboundAdjacency(inboundOffsets, inboundSenders, inboundAmounts);
+
+    vector<double> rank(nodeCount, 1.0 / nodeCount);
+    vector<double> nextRank(nodeCount);
+    vector<double> contribution(nodeCount);
+    vector<double> threadSums(getThreadCount());
+
+    for (size_t iteration = 0; iteration < maxIterations; ++iteration) {
+        // Rank sent per satoshi by each node, and rank 
+        // held by nodes without outbound edges.
+        threadSums.assign(threadSums.size(), 0);
+        parallelForBlocks(0, nodeCount, [&] (size_t threadIdx, size_t begin, size_t end) {
+            for (size_t nodeIdx = begin; nodeIdx < end; ++nodeIdx) {
+                if (outboundAmount[nodeIdx] > 0) {
+                    contribution[nodeIdx] = rank[nodeIdx] / outboundAmount[nodeIdx];
+                } else {
+                    contribution[nodeIdx] = 0;
+                    threadSums[threadIdx] += rank[nodeIdx];
+                }
+            }
+        });
+
+        double danglingRank = 0;
+        for (double sum : threadSums)
+            danglingRank += sum;
+
+        double baseRank = (1 - dampingFactor + dampingFactor * danglingRank) / nodeCount;
+
+        // Pull rank from senders of inbound edges.
+        threadSums.assign(threadSums.size(), 0);
+        parallelForBlocks(0, nodeCount, [&] (size_t threadIdx, size_t begin, size_t end) {
+            for (size_t nodeIdx = begin; nodeIdx < end; ++nodeIdx) {
+                double pulledRank = 0;
+                for (size_t i = inboundOffsets[nodeIdx]; i < inboundOffsets[nodeIdx + 1]; ++i)
+                    pulledRank += contribution[inboundSenders[i]] * inboundAmounts[i];
+
+                nextRank[nodeIdx] = baseRank + dampingFactor * pulledRank;
+                threadSums[threadIdx] += fabs(nextRank[nodeIdx] - rank[nodeIdx]);
+            }
+        });
+
+        rank.swap(nextRank);
+
+        double change = 0;
+        for (double sum : threadSums)
+            change += sum;
+
+        if (change < tolerance)
+            break;
+    }
+
+    return rank;
+}
+
+/**
+ * @brief Union HyperLogLog counter of source into target 
+ * by taking the maximum of every register.
+ * 
+ * @param target        Registers of target counter.
+ * @param source        Registers of source counter.
+ * @param registerCount Number of registers in each counter.
+ * @return bool         True if any register of target changed.
+ */
+static bool _unionRegisters(uint8_t* target, const uint8_t* source, size_t registerCount) {
+    size_t i = 0;
+    bool changed = false;
+
+#ifdef __SSE2__
+    // Unsigned byte maximum over 16 registers at a time.
+    for (; i + 16 <= registerCount; i += 16) {
+        __m128i targetRegisters = _mm_loadu_si128((const __m128i*) (target + i));
+        __m128i sourceRegisters = _mm_loadu_si128((const __m128i*) (source + i));
+        __m128i unionRegisters = _mm_max_epu8(targetRegisters, sourceRegisters);
+
+        changed |= _mm_movemask_epi8(_mm_cmpeq_epi8(unionRegisters, targetRegisters)) != 0xFFFF;
+        _mm_storeu_si128((__m128i*) (target + i), unionRegisters);
+    }
+#endif
+
+    for (; i < registerCount; ++i) {
+        changed |= source[i] > target[i];
+        target[i] = max(target[i], source[i]);
+    }
+
+    return changed;
+}
+
+/**
+ * @brief Estimate number of distinct items counted by HyperLogLog counter.
+ * 
+ * @param registers     Registers of counter.
+ * @param registerCount Number of registers, a power of 2 of at least 16.
+ * @return double       Estimated number of items.
+ */
+static double _estimateRegisters(const uint8_t* registers, size_t registerCount) {
+    double inverseSum = 0;
+    size_t zeroRegisters = 0;
+
+    for (size_t i = 0; i < registerCount; ++i) {
+        inverseSum += ldexp(1.0, -registers[i]);
+        zeroRegisters += registers[i] == 0;
+    }
+
+    double m = registerCount;
+    double alpha = m == 16 ? 0.673 : m == 32 ? 0.697 : m == 64 ? 0.709 : 0.7213 / (1 + 1.079 / m);
+    double estimate = alpha * m * m / inverseSum;
+
+    // Linear counting is more accurate for small counts.
+    if (estimate <= 2.5 * m && zeroRegisters > 0)
+        estimate = m * log(m / zeroRegisters);
+
+    return estimate;
+}
+
+vector<double> Graph::_hyperBall(unsigned int registerBits, size_t maxDistance, 
+                                 vector<double>& harmonic, vector<double>& closeness) const {
+    registerBits = min(16u, max(4u, registerBits));
+
+    size_t nodeCount = nodes_.size();
+    size_t registerCount = size_t(1) << registerBits;
+
+    harmonic.assign(nodeCount, 0);
+    closeness.assign(nodeCount, 0);
+
+    vector<double> neighborhoodFunction;
+    if (nodeCount == 0)
+        return neighborhoodFunction;
+
+    // Counters of every node stored contiguously, for current and next distance.
+    vector<uint8_t> registers(nodeCount * registerCount);
+    vector<uint8_t> nextRegisters(nodeCount * registerCount);
+
+    vector<double> estimate(nodeCount);
+    vector<double> distanceSum(nodeCount);
+    vector<char> changed(nodeCount, true);
+    vector<char> nextChanged(nodeCount);
+    vector<double> threadSums(getThreadCount());
+
+    // Counter of each node starts out holding only the node itself.
+    parallelFor(0, nodeCount, [&] (size_t nodeIdx) {
+        uint64_t hash = _hashNodeIdx(nodeIdx);
+        size_t registerIdx = hash >> (64 - registerBits);
+        uint64_t remainingBits = hash << registerBits;
+
+        uint8_t rank = 1;
+        while (rank <= 64 - registerBits && !(remainingBits & (1ULL << 63))) {
+            remainingBits <<= 1;
+            ++rank;
+        }
+
+        registers[nodeIdx * registerCount + registerIdx] = rank;
+        estimate[nodeIdx] = _estimateRegisters(&registers[nodeIdx * registerCount], registerCount);
+    });
+
+    double pairCount = 0;
+    for (double nodeEstimate : estimate)
+        pairCount += nodeEstimate;
+    neighborhoodFunction.push_back(pairCount);
+
+    for (size_t distance = 1; maxDistance == 0 || distance <= maxDistance; ++distance) {
+        threadSums.assign(threadSums.size(), 0);
+        atomic<bool> anyChanged(false);
+
+        parallelForBlocks(0, nodeCount, [&] (size_t threadIdx, size_t begin, size_t end) {
+            bool blockChanged = false;
+
+            for (size_t nodeIdx = begin; nodeIdx < end; ++nodeIdx) {
+                uint8_t* target = &nextRegisters[nodeIdx * registerCount];
+                const uint8_t* source = &registers[nodeIdx * registerCount];
+                copy(source, source + registerCount, target);
+
+                // Neighbors that did not change were already unioned at the last distance.
+                bool nodeChanged = false;
+                for (size_t edgeIdx : nodes_[nodeIdx].outbound) {
+                    size_t recipientIdx = edges_[edgeIdx].recipientIdx;
+                    if (changed[recipientIdx])
+                        nodeChanged |= _unionRegisters(target, &registers[recipientIdx * registerCount], registerCount);
+                }
+
+                nextChanged[nodeIdx] = nodeChanged;
+
+                if (nodeChanged) {
+                    double nextEstimate = _estimateRegisters(target, registerCount);
+                    double newlyReached = max(0.0, nextEstimate - estimate[nodeIdx]);
+
+                    harmonic[nodeIdx] += newlyReached / distance;
+                    distanceSum[nodeIdx] += newlyReached * distance;
+                    estimate[nodeIdx] = nextEstimate;
+                    blockChanged = true;
+                }
+
+                threadSums[threadIdx] += estimate[nodeIdx];
+            }
+
+            if (blockChanged)
+                anyChanged = true;
+        });
+
+        if (!anyChanged)
+            break;
+
+        registers.swap(nextRegisters);
+        changed.swap(nextChanged);
+
+        pairCount = 0;
+        for (double sum : threadSums)
+            pairCount += sum;
+        neighborhoodFunction.push_back(pairCount);
+    }
+
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx) {
+        if (distanceSum[nodeIdx] > 0)
+            closeness[nodeIdx] = 1 / distanceSum[nodeIdx];
+    }
+
+    return neighborhoodFunction;
+}
+
+vector<size_t> Graph::_getCoreness() const {
+    vector<size_t> offsets, neighbors;
+    _getUndirectedAdjacency(offsets, neighbors);
+
+    size_t nodeCount = nodes_.size();
+    size_t threadCount = getThreadCount();
+
+    vector<atomic<size_t>> degree(nodeCount);
+    vector<size_t> coreness(nodeCount);
+    vector<char> removed(nodeCount);
+
+    // Buckets of nodes by degree. Nodes are added again whenever their degree 
+    // drops, so entries whose degree no longer matches are skipped.
+    size_t maxDegree = 0;
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx)
+        maxDegree = max(maxDegree, offsets[nodeIdx + 1] - offsets[nodeIdx]);
+
+    vector<vector<size_t>> buckets(maxDegree + 1);
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx) {
+        degree[nodeIdx] = offsets[nodeIdx + 1] - offsets[nodeIdx];
+        buckets[degree[nodeIdx]].push_back(nodeIdx);
+    }
+
+    vector<size_t> frontier;
+    vector<vector<size_t>> threadFrontiers(threadCount);
+    vector<vector<pair<size_t, size_t>>> threadMoves(threadCount);
+
+    for (size_t k = 0; k <= maxDegree; ++k) {
+        frontier.clear();
+        for (size_t nodeIdx : buckets[k]) {
+            if (!removed[nodeIdx] && degree[nodeIdx] == k)
+                frontier.push_back(nodeIdx);
+        }
+
+        vector<size_t>().swap(buckets[k]);
+
+        // Peel all nodes of degree at most k, including 
+        // those whose degree drops to k while peeling.
+        while (!frontier.empty()) {
+            parallelFor(0, frontier.size(), [&] (size_t i) {
+                removed[frontier[i]] = true;
+                coreness[frontier[i]] = k;
+            });
+
+            parallelForBlocks(0, frontier.size(), [&] (size_t threadIdx, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    size_t nodeIdx = frontier[i];
+
+                    for (size_t j = offsets[nodeIdx]; j < offsets[nodeIdx + 1]; ++j) {
+                        size_t neighborIdx = neighbors[j];
+                        if (removed[neighborIdx])
+                            continue;
+
+                        // Exactly one decrement sees each new degree.
+                        size_t newDegree = --degree[neighborIdx];
+                        if (newDegree == k)
+                            threadFrontiers[threadIdx].push_back(neighborIdx);
+                        else if (newDegree > k)
+                            threadMoves[threadIdx].emplace_back(newDegree, neighborIdx);
+                    }
+                }
+            }, 64);
+
+            frontier.clear();
+            for (size_t threadIdx = 0; threadIdx < threadCount; ++threadIdx) {
+                frontier.insert(frontier.end(), threadFrontiers[threadIdx].begin(), threadFrontiers[threadIdx].end());
+                threadFrontiers[threadIdx].clear();
+
+                for (const auto& movedNode : threadMoves[threadIdx])
+                    buckets[movedNode.first].push_back(movedNode.second);
+                threadMoves[threadIdx].clear();
+            }
+        }
+    }
+
+    return coreness;
+}
+
+/**
+ * @brief Greedily peel node of smallest weighted degree until graph is 
+ * empty, keeping the densest set of remaining nodes seen.
+ * 
+ * @param offsets   Adjacency offsets of every node.
+ * @param neighbors Neighbors of every node, without self loops.
+ * @param weights   Weight of edge to every neighbor.
+ * @param excluded  Nodes left out of the graph.
+ * @param epsilon   Ratio between bucket bounds is 1 + epsilon.
+ * @param members   Nodes of densest set seen.
+ * @return double   Density of densest set seen.
+ * 
+ * Buckets hold nodes by the logarithm of their weighted degree. Nodes are added 
+ * again whenever their bucket changes, so stale entries are skipped.
+ */
+static double _greedyPeel(const vector<size_t>& offsets, const vector<size_t>& neighbors, const vector<double>& weights, 
+                          const vector<char>& excluded, double epsilon, vector<size_t>& members) {
+    size_t nodeCount = excluded.size();
+
+    vector<double> degree(nodeCount, 0);
+    double minWeight = numeric_limits<double>::max();
+    double totalWeight = 0;
+    size_t remaining = 0;
+
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx) {
+        if (excluded[nodeIdx])
+            continue;
+
+        for (size_t i = offsets[nodeIdx]; i < offsets[nodeIdx + 1]; ++i) {
+            if (!excluded[neighbors[i]] && weights[i] > 0) {
+                degree[nodeIdx] += weights[i];
+                minWeight = min(minWeight, weights[i]);
+            }
+        }
+
+        totalWeight += degree[nodeIdx] / 2;
+        ++remaining;
+    }
+
+    // Bucket of a degree, 0 for degrees below the smallest weight.
+    double logBase = log1p(max(epsilon, 1e-6));
+    auto getBucket = [&] (double d) -> size_t {
+        return d < minWeight ? 0 : 1 + (size_t) (log(d / minWeight) / logBase);
+    };
+
+    vector<size_t> bucket(nodeCount, 0);
+    vector<vector<size_t>> buckets(1);
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx) {
+        if (excluded[nodeIdx])
+            continue;
+
+        bucket[nodeIdx] = getBucket(degree[nodeIdx]);
+        if (bucket[nodeIdx] >= buckets.size())
+            buckets.resize(bucket[nodeIdx] + 1);
+        buckets[bucket[nodeIdx]].push_back(nodeIdx);
+    }
+
+    vector<char> removed(excluded);
+    vector<size_t> removalOrder;
+    double bestDensity = remaining > 0 ? totalWeight / remaining : 0;
+    size_t bestRemovedCount = 0;
+    size_t current = 0;
+
+    while (remaining > 0) {
+        // Find lowest bucket with a live entry.
+        size_t nodeIdx = nodeCount;
+        while (nodeIdx == nodeCount) {
+            while (buckets[current].empty())
+                ++current;
+
+            size_t candidateIdx = buckets[current].back();
+            buckets[current].pop_back();
+
+            if (!removed[candidateIdx] && bucket[candidateIdx] == current)
+                nodeIdx = candidateIdx;
+        }
+
+        removed[nodeIdx] = 1;
+        removalOrder.push_back(nodeIdx);
+        totalWeight -= degree[nodeIdx];
+        --remaining;
+
+        for (size_t i = offsets[nodeIdx]; i < offsets[nodeIdx + 1]; ++i) {
+            size_t neighborIdx = neighbors[i];
+            if (removed[neighborIdx] || weights[i] <= 0)
+                continue;
+
+            degree[neighborIdx] -= weights[i];
+
+            size_t newBucket = getBucket(degree[neighborIdx]);
+            if (newBucket != bucket[neighborIdx]) {
+                bucket[neighborIdx] = newBucket;
+                buckets[newBucket].push_back(neighborIdx);
+                current = min(current, newBucket);
+            }
+        }
+
+        if (remaining > 0 && totalWeight / remaining > bestDensity) {
+            bestDensity = totalWeight / remaining;
+            bestRemovedCount = removalOrder.size();
+        }
+    }
+
+    // Densest set is what remained after the best number of removals.
+    vector<char> peeled(excluded);
+    for (size_t i = 0; i < bestRemovedCount; ++i)
+        peeled[removalOrder[i]] = 1;
+
+    members.clear();
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx) {
+        if (!peeled[nodeIdx])
+            members.push_back(nodeIdx);
+    }
+
+    return bestDensity;
+}
+
+/**
+ * @brief Peel every node with weighted degree at most 2(1 + epsilon) times the 
+ * density in parallel rounds, keeping the densest set of remaining nodes seen.
+ * 
+ * @param offsets   Adjacency offsets of every node.
+ * @param neighbors Neighbors of every node, without self loops.
+ * @param weights   Weight of edge to every neighbor.
+ * @param excluded  Nodes left out of the graph.
+ * @param epsilon   Slack of removal threshold.
+ * @param members   Nodes of densest set seen.
+ * @return double   Density of densest set seen.
+ * 
+ * Degrees are updated by remaining nodes pulling from neighbors 
+ * removed in the round, so no two threads write the same degree.
+ */
+static double _batchPeel(const vector<size_t>& offsets, const vector<size_t>& neighbors, const vector<double>& weights, 
+                         const vector<char>& excluded, double epsilon, vector<size_t>& members) {
+    size_t nodeCount = excluded.size();
+    size_t notRemoved = numeric_limits<size_t>::max();
+
+    // Round each node was removed in.
+    vector<size_t> removedRound(nodeCount, notRemoved);
+    vector<double> degree(nodeCount, 0);
+    vector<size_t> remainingIdxs;
+
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx) {
+        if (excluded[nodeIdx]) {
+            removedRound[nodeIdx] = 0;
+            continue;
+        }
+
+        remainingIdxs.push_back(nodeIdx);
+    }
+
+    parallelFor(0, remainingIdxs.size(), [&] (size_t i) {
+        size_t nodeIdx = remainingIdxs[i];
+        for (size_t j = offsets[nodeIdx]; j < offsets[nodeIdx + 1]; ++j) {
+            if (!excluded[neighbors[j]])
+                degree[nodeIdx] += weights[j];
+        }
+    });
+
+    double bestDensity = 0;
+    size_t bestRound = 1;
+
+    // Rounds are numbered from 1 so excluded nodes count as removed before the first.
+    for (size_t round = 1; !remainingIdxs.empty(); ++round) {
+        double totalWeight = 0;
+        for (size_t nodeIdx : remainingIdxs)
+            totalWeight += degree[nodeIdx] / 2;
+
+        double density = totalWeight / remainingIdxs.size();
+        if (density > bestDensity || round == 1) {
+            bestDensity = density;
+            bestRound = round;
+        }
+
+        // Node of smallest degree is always at or below the threshold.
+        double threshold = 2 * (1 + epsilon) * density;
+        parallelFor(0, remainingIdxs.size(), [&] (size_t i) {
+            if (degree[remainingIdxs[i]] <= threshold)
+                removedRound[remainingIdxs[i]] = round;
+        });
+
+        size_t kept = 0;
+        for (size_t nodeIdx : remainingIdxs) {
+            if (removedRound[nodeIdx] == notRemoved)
+                remainingIdxs[kept++] = nodeIdx;
+        }
+        remainingIdxs.resize(kept);
+
+        parallelFor(0, remainingIdxs.size(), [&] (size_t i) {
+            size_t nodeIdx = remainingIdxs[i];
+            for (size_t j = offsets[nodeIdx]; j < offsets[nodeIdx + 1]; ++j) {
+                if (removedRound[neighbors[j]] == round)
+                    degree[nodeIdx] -= weights[j];
+            }
+        });
+    }
+
+    // Densest set is every node still remaining at the start of the best round.
+    members.clear();
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx) {
+        if (!excluded[nodeIdx] && removedRound[nodeIdx] >= bestRound)
+            members.push_back(nodeIdx);
+    }
+
+    return bestDensity;
+}
+
+double Graph::_getDensestSubgraph(const vector<size_t>& offsets, const vector<size_t>& neighbors, 
+                                  const vector<double>& weights, const vector<char>& excluded, 
+                                  double epsilon, bool batchPeeling, vector<size_t>& members) const {
+    if (batchPeeling)
+        return _batchPeel(offsets, neighbors, weights, excluded, epsilon, members);
+
+    return _greedyPeel(offsets, neighbors, weights, excluded, epsilon, members);
+}
+
+/**
+ * @brief Intersect two sorted lists without duplicates, 
+ * calling found(i, j) for every lhs[i] equal to rhs[j].
+ * 
+ * @param lhs     First sorted list.
+ * @param lhsSize Size of first list.
+ * @param rhs     Second sorted list.
+ * @param rhsSize Size of second list.
+ * @param found   Called with positions of every common element.
+ */
+template <typename Found>
+static void _intersectSorted(const uint32_t* lhs, size_t lhsSize, const uint32_t* rhs, size_t rhsSize, const Found& found) {
+    size_t i = 0;
+    size_t j = 0;
+
+#ifdef __SSE2__
+    // Compare blocks of 4 against every rotation of the other block, 
+    // then advance the block with the smaller maximum.
+    while (i + 4 <= lhsSize && j + 4 <= rhsSize) {
+        __m128i lhsBlock = _mm_loadu_si128((const __m128i*) (lhs + i));
+        __m128i rhsBlock = _mm_loadu_si128((const __m128i*) (rhs + j));
+
+        __m128i matches = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(lhsBlock, rhsBlock), 
+                         _mm_cmpeq_epi32(lhsBlock, _mm_shuffle_epi32(rhsBlock, _MM_SHUFFLE(0, 3, 2, 1)))),
+            _mm_or_si128(_mm_cmpeq_epi32(lhsBlock, _mm_shuffle_epi32(rhsBlock, _MM_SHUFFLE(1, 0, 3, 2))), 
+                         _mm_cmpeq_epi32(lhsBlock, _mm_shuffle_epi32(rhsBlock, _MM_SHUFFLE(2, 1, 0, 3)))));
+
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(matches));
+        while (mask) {
+            size_t lhsOffset = __builtin_ctz(mask);
+            mask &= mask - 1;
+
+            size_t rhsOffset = 0;
+            while (rhs[j + rhsOffset] != lhs[i + lhsOffset])
+                ++rhsOffset;
+
+            found(i + lhsOffset, j + rhsOffset);
+        }
+
+        uint32_t lhsMax = lhs[i + 3];
+        uint32_t rhsMax = rhs[j + 3];
+        if (lhsMax <= rhsMax)
+            i += 4;
+        if (rhsMax <= lhsMax)
+            j += 4;
+    }
+#endif
+
+    while (i < lhsSize && j < rhsSize) {
+        if (lhs[i] < rhs[j]) {
+            ++i;
+        } else if (rhs[j] < lhs[i]) {
+            ++j;
+        } else {
+            found(i, j);
+            ++i;
+            ++j;
+        }
+    }
+}
+
+Graph::CycleCounts Graph::_countCycles(vector<CycleCounts>& nodeCounts) const {
+    const uint8_t OUTBOUND = 1;
+    const uint8_t INBOUND = 2;
+
+    size_t nodeCount = nodes_.size();
+    size_t threadCount = getThreadCount();
+
+    vector<size_t> offsets, neighbors;
+    _getUndirectedAdjacency(offsets, neighbors);
+
+    // Sorted outbound and inbound neighbors of every node.
+    vector<vector<size_t>> outboundNeighbors(nodeCount), inboundNeighbors(nodeCount);
+    parallelFor(0, nodeCount, [&] (size_t nodeIdx) {
+        for (size_t edgeIdx : nodes_[nodeIdx].outbound)
+            outboundNeighbors[nodeIdx].push_back(edges_[edgeIdx].recipientIdx);
+        for (size_t edgeIdx : nodes_[nodeIdx].inbound)
+            inboundNeighbors[nodeIdx].push_back(edges_[edgeIdx].senderIdx);
+
+        sort(outboundNeighbors[nodeIdx].begin(), outboundNeighbors[nodeIdx].end());
+        sort(inboundNeighbors[nodeIdx].begin(), inboundNeighbors[nodeIdx].end());
+    });
+
+    // Rank nodes by undirected degree so every edge points to the higher degree node.
+    vector<size_t> nodeOfRank(nodeCount);
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx)
+        nodeOfRank[nodeIdx] = nodeIdx;
+
+    auto comparator = [&] (size_t lhsIdx, size_t rhsIdx) {
+        size_t lhsDegree = offsets[lhsIdx + 1] - offsets[lhsIdx];
+        size_t rhsDegree = offsets[rhsIdx + 1] - offsets[rhsIdx];
+        return lhsDegree < rhsDegree || (lhsDegree == rhsDegree && lhsIdx < rhsIdx);
+    };
+
+    sort(nodeOfRank.begin(), nodeOfRank.end(), comparator);
+
+    vector<uint32_t> rank(nodeCount);
+    for (size_t r = 0; r < nodeCount; ++r)
+        rank[nodeOfRank[r]] = r;
+
+    // Higher ranked neighbors of every node sorted by rank, with a mask 
+    // of the directions transactions with each neighbor were made in.
+    vector<size_t> orientedOffsets(nodeCount + 1, 0);
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx) {
+        size_t higherCount = 0;
+        for (size_t i = offsets[nodeIdx]; i < offsets[nodeIdx + 1]; ++i)
+            higherCount += rank[neighbors[i]] > rank[nodeIdx];
+        orientedOffsets[nodeIdx + 1] = orientedOffsets[nodeIdx] + higherCount;
+    }
+
+    vector<uint32_t> orientedNeighbors(orientedOffsets.back());
+    vector<uint8_t> orientedDirections(orientedOffsets.back());
+
+    parallelFor(0, nodeCount, [&] (size_t nodeIdx) {
+        const vector<size_t>& outbound = outboundNeighbors[nodeIdx];
+        const vector<size_t>& inbound = inboundNeighbors[nodeIdx];
+        vector<pair<uint32_t, uint8_t>> higher;
+        size_t outPos = 0;
+        size_t inPos = 0;
+
+        // Undirected, outbound and inbound neighbors are all sorted by index.
+        for (size_t i = offsets[nodeIdx]; i < offsets[nodeIdx + 1]; ++i) {
+            size_t neighborIdx = neighbors[i];
+            uint8_t direction = 0;
+
+            while (outPos < outbound.size() && outbound[outPos] < neighborIdx)
+                ++outPos;
+            if (outPos < outbound.size() && outbound[outPos] == neighborIdx)
+                direction |= OUTBOUND;
+
+            while (inPos < inbound.size() && inbound[inPos] < neighborIdx)
+                ++inPos;
+            if (inPos < inbound.size() && inbound[inPos] == neighborIdx)
+                direction |= INBOUND;
+
+            if (rank[neighborIdx] > rank[nodeIdx])
+                higher.emplace_back(rank[neighborIdx], direction);
+        }
+
+        sort(higher.begin(), higher.end());
+        for (size_t i = 0; i < higher.size(); ++i) {
+            orientedNeighbors[orientedOffsets[nodeIdx] + i] = higher[i].first;
+            orientedDirections[orientedOffsets[nodeIdx] + i] = higher[i].second;
+        }
+    });
+
+    vector<atomic<size_t>> twoCycles(nodeCount), threeCycles(nodeCount), triangles(nodeCount);
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx)
+        twoCycles[nodeIdx] = threeCycles[nodeIdx] = triangles[nodeIdx] = 0;
+
+    vector<CycleCounts> threadTotals(threadCount);
+
+    parallelForBlocks(0, nodeCount, [&] (size_t threadIdx, size_t begin, size_t end) {
+        CycleCounts& totals = threadTotals[threadIdx];
+
+        for (size_t u = begin; u < end; ++u) {
+            const uint32_t* uNeighbors = orientedNeighbors.data() + orientedOffsets[u];
+            const uint8_t* uDirections = orientedDirections.data() + orientedOffsets[u];
+            size_t uDegree = orientedOffsets[u + 1] - orientedOffsets[u];
+
+            for (size_t i = 0; i < uDegree; ++i) {
+                size_t v = nodeOfRank[uNeighbors[i]];
+                uint8_t uvDirection = uDirections[i];
+
+                if (uvDirection == (OUTBOUND | INBOUND)) {
+                    ++totals.twoCycles;
+                    twoCycles[u].fetch_add(1, std::memory_order_relaxed);
+                    twoCycles[v].fetch_add(1, std::memory_order_relaxed);
+                }
+
+                const uint32_t* vNeighbors = orientedNeighbors.data() + orientedOffsets[v];
+                const uint8_t* vDirections = orientedDirections.data() + orientedOffsets[v];
+                size_t vDegree = orientedOffsets[v + 1] - orientedOffsets[v];
+
+                // Every common higher ranked neighbor w closes a triangle counted only from u.
+                _intersectSorted(uNeighbors, uDegree, vNeighbors, vDegree, [&] (size_t uwPos, size_t vwPos) {
+                    size_t w = nodeOfRank[uNeighbors[uwPos]];
+                    uint8_t uwDirection = uDirections[uwPos];
+                    uint8_t vwDirection = vDirections[vwPos];
+
+                    // Cycles u -> v -> w -> u and u -> w -> v -> u.
+                    size_t cycles = ((uvDirection & OUTBOUND) && (vwDirection & OUTBOUND) && (uwDirection & INBOUND)) + 
+                                    ((uwDirection & OUTBOUND) && (vwDirection & INBOUND) && (uvDirection & INBOUND));
+
+                    ++totals.triangles;
+                    totals.threeCycles += cycles;
+
+                    for (size_t nodeIdx : { u, v, w }) {
+                        triangles[nodeIdx].fetch_add(1, std::memory_order_relaxed);
+                        if (cycles)
+                            threeCycles[nodeIdx].fetch_add(cycles, std::memory_order_relaxed);
+                    }
+                });
+            }
+        }
+    }, 64);
+
+    nodeCounts.assign(nodeCount, CycleCounts());
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx) {
+        nodeCounts[nodeIdx].twoCycles = twoCycles[nodeIdx];
+        nodeCounts[nodeIdx].threeCycles = threeCycles[nodeIdx];
+        nodeCounts[nodeIdx].triangles = triangles[nodeIdx];
+    }
+
+    CycleCounts totals;
+    for (const CycleCounts& threadTotal : threadTotals) {
+        totals.twoCycles += threadTotal.twoCycles;
+        totals.threeCycles += threadTotal.threeCycles;
+        totals.triangles += threadTotal.triangles;
+    }
+
+    return totals;
+}
+
+void Graph::_buildAliasTable(AliasTable& table) const {
+    size_t nodeCount = nodes_.size();
+
+    table.offsets.assign(nodeCount + 1, 0);
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx)
+        table.offsets[nodeIdx + 1] = table.offsets[nodeIdx] + nodes_[nodeIdx].outbound.size();
+
+    table.recipients.resize(table.offsets.back());
+    table.probability.resize(table.offsets.back());
+    table.alias.resize(table.offsets.back());
+
+    parallelForBlocks(0, nodeCount, [&] (size_t, size_t begin, size_t end) {
+        vector<size_t> small, large;
+        vector<double> scaled;
+
+        for (size_t nodeIdx = begin; nodeIdx < end; ++nodeIdx) {
+            const vector<size_t>& outbound = nodes_[nodeIdx].outbound;
+            size_t offset = table.offsets[nodeIdx];
+            size_t degree = outbound.size();
+
+            double outboundAmount = 0;
+            for (size_t edgeIdx : outbound)
+                outboundAmount += _getEdgeTransactionAmount(edgeIdx);
+
+            // Scale amounts so the average entry has weight 1.
+            scaled.resize(degree);
+            for (size_t i = 0; i < degree; ++i) {
+                table.recipients[offset + i] = edges_[outbound[i]].recipientIdx;
+                scaled[i] = _getEdgeTransactionAmount(outbound[i]) * degree / outboundAmount;
+                (scaled[i] < 1 ? small : large).push_back(i);
+            }
+
+            // Pair every light entry with a heavy entry that covers its remainder.
+            while (!small.empty() && !large.empty()) {
+                size_t light = small.back();
+                size_t heavy = large.back();
+                small.pop_back();
+
+                table.probability[offset + light] = scaled[light];
+                table.alias[offset + light] = heavy;
+
+                scaled[heavy] -= 1 - scaled[light];
+                if (scaled[heavy] < 1) {
+                    large.pop_back();
+                    small.push_back(heavy);
+                }
+            }
+
+            // Remaining entries are 1 up to rounding error.
+            for (size_t i : small) {
+                table.probability[offset + i] = 1;
+                table.alias[offset + i] = i;
+            }
+            for (size_t i : large) {
+                table.probability[offset + i] = 1;
+                table.alias[offset + i] = i;
+            }
+
+            small.clear();
+            large.clear();
+        }
+    });
+}
+
+size_t Graph::_sampleOutbound(const AliasTable& table, size_t nodeIdx, mt19937_64& generator) const {
+    size_t offset = table.offsets[nodeIdx];
+    size_t degree = table.offsets[nodeIdx + 1] - offset;
+
+    if (degree == 0)
+        return nodes_.size();
+
+    uniform_real_distribution<double> uniform(0, 1);
+    size_t entry = generator() % degree;
+
+    if (uniform(generator) >= table.probability[offset + entry])
+        entry = table.alias[offset + entry];
+
+    return table.recipients[offset + entry];
+}
+
+void Graph::_getInboundAdjacency(vector<size_t>& offsets, vector<size_t>& senders, vector<double>& amounts) const {
+    size_t nodeCount = nodes_.size();
+
+    offsets.assign(nodeCount + 1, 0);
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx)
+        offsets[nodeIdx + 1] = offsets[nodeIdx] + nodes_[nodeIdx].inbound.size();
+
+    senders.resize(offsets.back());
+    amounts.resize(offsets.back());
+    parallelFor(0, nodeCount, [&] (size_t nodeIdx) {
+        size_t offset = offsets[nodeIdx];
+        for (size_t edgeIdx : nodes_[nodeIdx].inbound) {
+            senders[offset] = edges_[edgeIdx].senderIdx;
+            amounts[offset] = _getEdgeTransactionAmount(edgeIdx);
+            ++offset;
+        }
+    });
+}
+
+void Graph::_getUndirectedAdjacency(vector<size_t>& offsets, vector<size_t>& neighbors, vector<double>* weights) const {
+    size_t nodeCount = nodes_.size();
+
+    vector<size_t> allOffsets(nodeCount + 1, 0);
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx) {
+        const Node& node = nodes_[nodeIdx];
+        allOffsets[nodeIdx + 1] = allOffsets[nodeIdx] + node.outbound.size() + node.inbound.size();
+    }
+
+    // Gather, sort and merge neighbors of each node in parallel, 
+    // summing amounts of transactions in both directions.
+    vector<pair<size_t, double>> allNeighbors(allOffsets.back());
+    vector<size_t> uniqueCounts(nodeCount);
+    parallelFor(0, nodeCount, [&] (size_t nodeIdx) {
+        const Node& node = nodes_[nodeIdx];
+        auto begin = allNeighbors.begin() + allOffsets[nodeIdx];
+        auto end = begin;
+
+        for (size_t edgeIdx : node.outbound) {
+            if (edges_[edgeIdx].recipientIdx != nodeIdx)
+                *end++ = pair<size_t, double>(edges_[edgeIdx].recipientIdx, convertSatoshiToBTC(_getEdgeTransactionAmount(edgeIdx)));
+        }
+
+        for (size_t edgeIdx : node.inbound) {
+            if (edges_[edgeIdx].senderIdx != nodeIdx)
+                *end++ = pair<size_t, double>(edges_[edgeIdx].senderIdx, convertSatoshiToBTC(_getEdgeTransactionAmount(edgeIdx)));
+        }
+
+        sort(begin, end);
+
+        auto last = begin;
+        for (auto it = begin; it != end; ++it) {
+            if (it != begin && it -> first == (last - 1) -> first)
+                (last - 1) -> second += it -> second;
+            else
+                *last++ = *it;
+        }
+
+        uniqueCounts[nodeIdx] = last - begin;
+    });
+
+    offsets.assign(nodeCount + 1, 0);
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx)
+        offsets[nodeIdx + 1] = offsets[nodeIdx] + uniqueCounts[nodeIdx];
+
+    neighbors.resize(offsets.back());
+    if (weights)
+        weights -> resize(offsets.back());
+
+    parallelFor(0, nodeCount, [&] (size_t nodeIdx) {
+        for (size_t i = 0; i < uniqueCounts[nodeIdx]; ++i) {
+            const pair<size_t, double>& neighbor = allNeighbors[allOffsets[nodeIdx] + i];
+            neighbors[offsets[nodeIdx] + i] = neighbor.first;
+            if (weights)
+                (*weights)[offsets[nodeIdx] + i] = neighbor.second;
+        }
+    });
+}
+
+// Key of unused slots of WeightAccumulator.
+static const size_t EMPTY_WEIGHT_KEY = numeric_limits<size_t>::max();
+
+/**
+ * Sums weights by community for one node at a time. Its hash table is 
+ * sized to the neighborhood of the node, so each thread holds memory 
+ * for its largest neighborhood instead of for every community.
+ */
+class WeightAccumulator {
+public:
+    /**
+     * @brief Clear sums, making room for up to count keys.
+     * 
+     * @param count Maximum number of keys added before the next reset.
+     */
+    void reset(size_t count) {
+        size_t bits = 4;
+        while (((size_t) 1 << bits) < 2 * count)
+            ++bits;
+
+        if (bits > bits_) {
+            bits_ = bits;
+            slotKeys_.assign((size_t) 1 << bits_, EMPTY_WEIGHT_KEY);
+            slotWeights_.assign((size_t) 1 << bits_, 0);
+        } else {
+            // Only slots used by the last node need to be cleared.
+            for (size_t slot : usedSlots_) {
+                slotKeys_[slot] = EMPTY_WEIGHT_KEY;
+                slotWeights_[slot] = 0;
+            }
+        }
+
+        usedSlots_.clear();
+    }
+
+    /**
+     * @brief Add weight to sum of key.
+     */
+    void add(size_t key, double weight) {
+        size_t slot = _findSlot(key);
+        if (slotKeys_[slot] == EMPTY_WEIGHT_KEY) {
+            slotKeys_[slot] = key;
+            usedSlots_.push_back(slot);
+        }
+        slotWeights_[slot] += weight;
+    }
+
+    /**
+     * @brief Get sum of key, 0 if it was not added.
+     */
+    double get(size_t key) const {
+        return slotWeights_[_findSlot(key)];
+    }
+
+    /**
+     * @brief Get number of keys added since reset.
+     */
+    size_t size() const {
+        return usedSlots_.size();
+    }
+
+    /**
+     * @brief Get i-th key added since reset, and its sum.
+     */
+    size_t getKey(size_t i) const {
+        return slotKeys_[usedSlots_[i]];
+    }
+
+    double getWeight(size_t i) const {
+        return slotWeights_[usedSlots_[i]];
+    }
+
+private:
+    size_t bits_ = 0;
+    vector<size_t> slotKeys_;
+    vector<double> slotWeights_;
+    vector<size_t> usedSlots_;
+
+    /**
+     * @brief Find slot of key with linear probing, or the empty slot it would take.
+     */
+    size_t _findSlot(size_t key) const {
+        size_t mask = ((size_t) 1 << bits_) - 1;
+        size_t slot = (size_t) ((key * 0x9E3779B97F4A7C15ull) >> (64 - bits_));
+
+        while (slotKeys_[slot] != key && slotKeys_[slot] != EMPTY_WEIGHT_KEY)
+            slot = (slot + 1) & mask;
+
+        return slot;
+    }
+};
+
+/**
+ * @brief Renumber communities consecutively from 0, 
+ * ordered from largest to smallest community.
+ * 
+ * @param community Community of every node, renumbered in place.
+ * @return size_t   Number of communities.
+ */
+static size_t _renumberCommunities(vector<size_t>& community) {
+    const size_t UNASSIGNED = numeric_limits<size_t>::max();
+
+    vector<size_t> size(community.size());
+    for (size_t c : community)
+        ++size[c];
+
+    vector<size_t> order;
+    for (size_t c = 0; c < size.size(); ++c) {
+        if (size[c] > 0)
+            order.push_back(c);
+    }
+
+    // Comparator for ordering communities by size, ties broken by old id.
+    auto comparator = [&] (size_t lhs, size_t rhs) {
+        return size[lhs] > size[rhs] || (size[lhs] == size[rhs] && lhs < rhs);
+    };
+
+    sort(order.begin(), order.end(), comparator);
+
+    vector<size_t> newId(size.size(), UNASSIGNED);
+    for (size_t i = 0; i < order.size(); ++i)
+        newId[order[i]] = i;
+
+    for (size_t& c : community)
+        c = newId[c];
+
+    return order.size();
+}
+
+/**
+ * @brief Get modularity of communities in weighted undirected graph.
+ * 
+ * @param offsets         Adjacency offsets of every node.
+ * @param neighbors       Neighbors of every node.
+ * @param weights         Weight of edge to every neighbor.
+ * @param degree          Total weight of edges of every node.
+ * @param totalWeight     Total weight of edges of all nodes.
+ * @param community       Community of every node.
+ * @param communityDegree List to fill with total degree of every community.
+ * @return double         Modularity of communities.
+ */
+static double _getModularity(const vector<size_t>& offsets, const vector<size_t>& neighbors, 
+                             const vector<double>& weights, const vector<double>& degree, double totalWeight, 
+                             const vector<size_t>& community, vector<double>& communityDegree) {
+    size_t nodeCount = community.size();
+
+    communityDegree.assign(nodeCount, 0);
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx)
+        communityDegree[community[nodeIdx]] += degree[nodeIdx];
+
+    vector<double> threadSums(getThreadCount());
+    parallelForBlocks(0, nodeCount, [&] (size_t threadIdx, size_t begin, size_t end) {
+        for (size_t nodeIdx = begin; nodeIdx < end; ++nodeIdx) {
+            for (size_t i = offsets[nodeIdx]; i < offsets[nodeIdx + 1]; ++i) {
+                if (community[neighbors[i]] == community[nodeIdx])
+                    threadSums[threadIdx] += weights[i];
+            }
+        }
+    });
+
+    double internalWeight = 0;
+    for (double sum : threadSums)
+        internalWeight += sum;
+
+    double expectedWeight = 0;
+    for (double d : communityDegree)
+        expectedWeight += (d / totalWeight) * (d / totalWeight);
+
+    return internalWeight / totalWeight - expectedWeight;
+}
+
+/**
+ * @brief Move every node of weighted undirected graph to the neighboring community 
+ * with the highest modularity gain, until modularity stops improving.
+ * 
+ * @param offsets       Adjacency offsets of every node.
+ * @param neighbors     Neighbors of every node, including self loops.
+ * @param weights       Weight of edge to every neighbor.
+ * @param community     Community of every node, updated in place.
+ * @param maxIterations Maximum number of passes over all nodes.
+ * 
+ * Moves of all nodes are decided in parallel from the previous pass, 
+ * accumulating weight to neighboring communities in per-thread hash tables.
+ */
+static void _louvainMoveNodes(const vector<size_t>& offsets, const vector<size_t>& neighbors, 
+                              const vector<double>& weights, vector<size_t>& community, size_t maxIterations) {
+    const double MIN_IMPROVEMENT = 1e-6;
+
+    size_t nodeCount = community.size();
+    size_t threadCount = getThreadCount();
+
+    vector<double> degree(nodeCount);
+    parallelFor(0, nodeCount, [&] (size_t nodeIdx) {
+        for (size_t i = offsets[nodeIdx]; i < offsets[nodeIdx + 1]; ++i)
+            degree[nodeIdx] += weights[i];
+    });
+
+    double totalWeight = 0;
+    for (double d : degree)
+        totalWeight += d;
+
+    if (totalWeight <= 0)
+        return;
+
+    vector<double> communityDegree;
+    vector<double> nextCommunityDegree;
+    vector<size_t> communitySize(nodeCount);
+    vector<size_t> nextCommunity(nodeCount);
+
+    // Weight from current node to each neighboring community.
+    vector<WeightAccumulator> threadWeights(threadCount);
+
+    double modularity = _getModularity(offsets, neighbors, weights, degree, totalWeight, community, communityDegree);
+
+    for (size_t iteration = 0; iteration < maxIterations; ++iteration) {
+        communitySize.assign(nodeCount, 0);
+        for (size_t c : community)
+            ++communitySize[c];
+
+        parallelForBlocks(0, nodeCount, [&] (size_t threadIdx, size_t begin, size_t end) {
+            WeightAccumulator& communityWeight = threadWeights[threadIdx];
+
+            for (size_t nodeIdx = begin; nodeIdx < end; ++nodeIdx) {
+                size_t ownCommunity = community[nodeIdx];
+                communityWeight.reset(offsets[nodeIdx + 1] - offsets[nodeIdx]);
+
+                for (size_t i = offsets[nodeIdx]; i < offsets[nodeIdx + 1]; ++i) {
+                    size_t neighborIdx = neighbors[i];
+                    if (neighborIdx == nodeIdx)
+                        continue;
+
+                    communityWeight.add(community[neighborIdx], weights[i]);
+                }
+
+                // Gain of joining each community after leaving own community.
+                double scale = degree[nodeIdx] / totalWeight;
+                size_t bestCommunity = ownCommunity;
+                double bestGain = communityWeight.get(ownCommunity) - scale * (communityDegree[ownCommunity] - degree[nodeIdx]);
+
+                for (size_t j = 0; j < communityWeight.size(); ++j) {
+                    size_t c = communityWeight.getKey(j);
+                    double gain = communityWeight.getWeight(j) - scale * communityDegree[c];
+                    if (c != ownCommunity && (gain > bestGain || (gain == bestGain && bestCommunity != ownCommunity && c < bestCommunity))) {
+                        bestGain = gain;
+                        bestCommunity = c;
+                    }
+                }
+
+                // Two singletons would swap communities forever, so 
+                // only allow joining the singleton with the smaller id.
+                if (communitySize[ownCommunity] == 1 && communitySize[bestCommunity] == 1 && bestCommunity > ownCommunity)
+                    bestCommunity = ownCommunity;
+
+                nextCommunity[nodeIdx] = bestCommunity;
+            }
+        });
+
+        double nextModularity = _getModularity(offsets, neighbors, weights, degree, totalWeight, nextCommunity, nextCommunityDegree);
+        if (nextModularity < modularity + MIN_IMPROVEMENT)
+            break;
+
+        community.swap(nextCommunity);
+        communityDegree.swap(nextCommunityDegree);
+        modularity = nextModularity;
+    }
+}
+
+/**
+ * @brief Coarsen weighted undirected graph by merging every community into 
+ * a single node, with edges inside a community becoming a self loop.
+ * 
+ * @param offsets        Adjacency offsets of every node, replaced by coarse graph.
+ * @param neighbors      Neighbors of every node, replaced by coarse graph.
+ * @param weights        Weight of edge to every neighbor, replaced by coarse graph.
+ * @param community      Community of every node, numbered consecutively from 0.
+ * @param communityCount Number of communities.
+ */
+static void _louvainCoarsen(vector<size_t>& offsets, vector<size_t>& neighbors, vector<double>& weights, 
+                            const vector<size_t>& community, size_t communityCount) {
+    size_t nodeCount = community.size();
+    size_t threadCount = getThreadCount();
+
+    // Bucket nodes by community.
+    vector<size_t> memberOffsets(communityCount + 1, 0);
+    for (size_t c : community)
+        ++memberOffsets[c + 1];
+    for (size_t c = 0; c < communityCount; ++c)
+        memberOffsets[c + 1] += memberOffsets[c];
+
+    vector<size_t> members(nodeCount);
+    vector<size_t> position(memberOffsets.begin(), memberOffsets.end() - 1);
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx)
+        members[position[community[nodeIdx]]++] = nodeIdx;
+
+    vector<vector<pair<size_t, double>>> rows(communityCount);
+    vector<WeightAccumulator> threadWeights(threadCount);
+
+    parallelForBlocks(0, communityCount, [&] (size_t threadIdx, size_t begin, size_t end) {
+        WeightAccumulator& communityWeight = threadWeights[threadIdx];
+
+        for (size_t c = begin; c < end; ++c) {
+            // Members have at most this many neighboring communities.
+            size_t edgeCount = 0;
+            for (size_t m = memberOffsets[c]; m < memberOffsets[c + 1]; ++m)
+                edgeCount += offsets[members[m] + 1] - offsets[members[m]];
+            communityWeight.reset(edgeCount);
+
+            for (size_t m = memberOffsets[c]; m < memberOffsets[c + 1]; ++m) {
+                size_t nodeIdx = members[m];
+
+                for (size_t i = offsets[nodeIdx]; i < offsets[nodeIdx + 1]; ++i)
+                    communityWeight.add(community[neighbors[i]], weights[i]);
+            }
+
+            for (size_t j = 0; j < communityWeight.size(); ++j)
+                rows[c].emplace_back(communityWeight.getKey(j), communityWeight.getWeight(j));
+            sort(rows[c].begin(), rows[c].end());
+        }
+    }, 64);
+
+    offsets.assign(communityCount + 1, 0);
+    for (size_t c = 0; c < communityCount; ++c)
+        offsets[c + 1] = offsets[c] + rows[c].size();
+
+    neighbors.resize(offsets.back());
+    weights.resize(offsets.back());
+    parallelFor(0, communityCount, [&] (size_t c) {
+        for (size_t i = 0; i < rows[c].size(); ++i) {
+            neighbors[offsets[c] + i] = rows[c][i].first;
+            weights[offsets[c] + i] = rows[c][i].second;
+        }
+    });
+}
+
+vector<size_t> Graph::_getLouvainCommunities(size_t maxLevels) const {
+    const size_t MAX_ITERATIONS = 20;
+
+    vector<size_t> offsets, neighbors;
+    vector<double> weights;
+    _getUndirectedAdjacency(offsets, neighbors, &weights);
+
+    vector<size_t> nodeCommunity(nodes_.size());
+    for (size_t nodeIdx = 0; nodeIdx < nodes_.size(); ++nodeIdx)
+        nodeCommunity[nodeIdx] = nodeIdx;
+
+    for (size_t level = 0; level < maxLevels; ++level) {
+        size_t levelNodeCount = offsets.size() - 1;
+
+        vector<size_t> community(levelNodeCount);
+        for (size_t nodeIdx = 0; nodeIdx < levelNodeCount; ++nodeIdx)
+            community[nodeIdx] = nodeIdx;
+
+        _louvainMoveNodes(offsets, neighbors, weights, community, MAX_ITERATIONS);
+        size_t communityCount = _renumberCommunities(community);
+
+        // Nodes of this level are the communities of the last level.
+        for (size_t& c : nodeCommunity)
+            c = community[c];
+
+        if (communityCount == levelNodeCount)
+            break;
+
+        _louvainCoarsen(offsets, neighbors, weights, community, communityCount);
+    }
+
+    _renumberCommunities(nodeCommunity);
+
+    return nodeCommunity;
+}
+
+vector<size_t> Graph::_getLabelPropagationCommunities(size_t maxIterations) const {
+    vector<size_t> offsets, neighbors;
+    vector<double> weights;
+    _getUndirectedAdjacency(offsets, neighbors, &weights);
+
+    size_t nodeCount = nodes_.size();
+    size_t threadCount = getThreadCount();
+
+    // Labels are updated in place while other threads read them.
+    vector<atomic<size_t>> label(nodeCount);
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx)
+        label[nodeIdx].store(nodeIdx, std::memory_order_relaxed);
+
+    vector<WeightAccumulator> threadWeights(threadCount);
+
+    for (size_t iteration = 0; iteration < maxIterations; ++iteration) {
+        atomic<size_t> changedCount(0);
+
+        parallelForBlocks(0, nodeCount, [&] (size_t threadIdx, size_t begin, size_t end) {
+            WeightAccumulator& labelWeight = threadWeights[threadIdx];
+            size_t blockChangedCount = 0;
+
+            for (size_t nodeIdx = begin; nodeIdx < end; ++nodeIdx) {
+                labelWeight.reset(offsets[nodeIdx + 1] - offsets[nodeIdx]);
+
+                for (size_t i = offsets[nodeIdx]; i < offsets[nodeIdx + 1]; ++i)
+                    labelWeight.add(label[neighbors[i]].load(std::memory_order_relaxed), weights[i]);
+
+                // Keep current label unless another label is strictly heavier.
+                size_t ownLabel = label[nodeIdx].load(std::memory_order_relaxed);
+                size_t bestLabel = ownLabel;
+                double bestWeight = labelWeight.get(ownLabel);
+
+                for (size_t j = 0; j < labelWeight.size(); ++j) {
+                    size_t l = labelWeight.getKey(j);
+                    double weight = labelWeight.getWeight(j);
+
+                    if (weight > bestWeight || (weight == bestWeight && bestLabel != ownLabel && l < bestLabel)) {
+                        bestWeight = weight;
+                        bestLabel = l;
+                    }
+                }
+
+                if (bestLabel != ownLabel) {
+                    label[nodeIdx].store(bestLabel, std::memory_order_relaxed);
+                    ++blockChangedCount;
+                }
+            }
+
+            changedCount += blockChangedCount;
+        });
+
+        if (changedCount == 0)
+            break;
+    }
+
+    vector<size_t> community(nodeCount);
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx)
+        community[nodeIdx] = label[nodeIdx].load(std::memory_order_relaxed);
+
+    _renumberCommunities(community);
+
+    return community;
+}
+
+vector<pair<string, size_t>> Graph::_listCommunities(const vector<size_t>& community) const {
+    vector<pair<string, size_t>> communityWithAddress;
+
+    vector<size_t> nodeIdxs(community.size());
+    for (size_t nodeIdx = 0; nodeIdx < community.size(); ++nodeIdx)
+        nodeIdxs[nodeIdx] = nodeIdx;
+
+    // Comparator for ordering nodes by community.
+    auto comparator = [&] (size_t lhsIdx, size_t rhsIdx) {
+        return community[lhsIdx] < community[rhsIdx];
+    };
+
+    stable_sort(nodeIdxs.begin(), nodeIdxs.end(), comparator);
+
+    for (size_t nodeIdx : nodeIdxs)
+        communityWithAddress.emplace_back(nodes_[nodeIdx].address, community[nodeIdx]);
+
+    return communityWithAddress;
+}
+
+vector<pair<string, double>> Graph::_rankAddresses(const vector<double>& scores) const {
+    Ranking ranking = _rankNodes(scores, 0);
+    vector<pair<string, double>> scoresWithAddress;
+    scoresWithAddress.reserve(ranking.size());
+
+    for (size_t rank = 0; rank < ranking.size(); ++rank)
+        scoresWithAddress.emplace_back(ranking.getAddress(rank), ranking.getScore(rank));
+
+    return scoresWithAddress;
+}
+
+Graph::Ranking Graph::_rankNodes(const vector<double>& scores, size_t k) const {
+    Ranking ranking;
+    ranking.graph_ = this;
+
+    for (size_t nodeIdx = 0; nodeIdx < scores.size(); ++nodeIdx) {
+        if (scores[nodeIdx] >= 0)
+            ranking.nodeIdxs_.push_back(nodeIdx);
+    }
+
+    // Comparator for ordering nodes by score, ties broken by index.
+    auto comparator = [&] (size_t lhsIdx, size_t rhsIdx) {
+        return scores[lhsIdx] > scores[rhsIdx] || (scores[lhsIdx] == scores[rhsIdx] && lhsIdx < rhsIdx);
+    };
+
+    vector<size_t>& nodeIdxs = ranking.nodeIdxs_;
+    if (k == 0 || k >= nodeIdxs.size()) {
+        parallelSort(nodeIdxs.begin(), nodeIdxs.end(), comparator);
+    } else {
+        // Only the top k are sorted, after selecting them in linear time.
+        nth_element(nodeIdxs.begin(), nodeIdxs.begin() + k, nodeIdxs.end(), comparator);
+        nodeIdxs.resize(k);
+        sort(nodeIdxs.begin(), nodeIdxs.end(), comparator);
+    }
+
+    for (size_t nodeIdx : nodeIdxs)
+        ranking.scores_.push_back(scores[nodeIdx]);
+
+    return ranking;
+}
+
+vector<double> Graph::_getTaint(const vector<size_t>& seedIdxs, size_t hopLimit, double threshold) const {
+    // Frontiers larger than this fraction of nodes are pulled 
+    // over all nodes instead of pushed from the frontier.
+    const double DENSE_FRONTIER_FRACTION = 0.05;
+
+    size_t nodeCount = nodes_.size();
+    size_t threadCount = getThreadCount();
+
+    vector<size_t> inboundOffsets, inboundSenders;
+    vector<double> inboundAmounts;
+    _getInboundAdjacency(inboundOffsets, inboundSenders, inboundAmounts);
+
+    vector<double> inflow(nodeCount);
+    parallelFor(0, nodeCount, [&] (size_t nodeIdx) {
+        for (size_t i = inboundOffsets[nodeIdx]; i < inboundOffsets[nodeIdx + 1]; ++i)
+            inflow[nodeIdx] += inboundAmounts[i];
+    });
+
+    vector<double> taint(nodeCount);
+    vector<double> taintedInflow(nodeCount);
+    vector<double> pulledInflow(nodeCount);
+
+    // Change in taint of frontier nodes since it was last propagated, zero elsewhere.
+    vector<double> delta(nodeCount);
+    vector<char> isSeed(nodeCount);
+
+    vector<size_t> frontier;
+    for (size_t seedIdx : seedIdxs) {
+        if (!isSeed[seedIdx]) {
+            isSeed[seedIdx] = true;
+            taint[seedIdx] = delta[seedIdx] = 1;
+            frontier.push_back(seedIdx);
+        }
+    }
+
+    vector<vector<size_t>> threadFrontiers(threadCount);
+    vector<size_t> touched;
+    vector<char> isTouched(nodeCount);
+
+    for (size_t hop = 0; (hopLimit == 0 || hop < hopLimit) && !frontier.empty(); ++hop) {
+        if (frontier.size() > DENSE_FRONTIER_FRACTION * nodeCount) {
+            // Pull tainted amounts over inbound edges of every node.
+            parallelFor(0, nodeCount, [&] (size_t nodeIdx) {
+                double pulled = 0;
+                for (size_t i = inboundOffsets[nodeIdx]; i < inboundOffsets[nodeIdx + 1]; ++i)
+                    pulled += delta[inboundSenders[i]] * inboundAmounts[i];
+                pulledInflow[nodeIdx] = pulled;
+            });
+
+            for (size_t nodeIdx : frontier)
+                delta[nodeIdx] = 0;
+
+            // Dense update over all nodes, free of branches so it vectorizes.
+            for (size_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx) {
+                double newTaintedInflow = taintedInflow[nodeIdx] + pulledInflow[nodeIdx];
+                double newTaint = isSeed[nodeIdx] ? 1.0 : min(1.0, newTaintedInflow / max(inflow[nodeIdx], 1.0));
+
+                delta[nodeIdx] = newTaint - taint[nodeIdx];
+                taintedInflow[nodeIdx] = newTaintedInflow;
+                taint[nodeIdx] = newTaint;
+            }
+
+            parallelForBlocks(0, nodeCount, [&] (size_t threadIdx, size_t begin, size_t end) {
+                for (size_t nodeIdx = begin; nodeIdx < end; ++nodeIdx) {
+                    if (delta[nodeIdx] > threshold)
+                        threadFrontiers[threadIdx].push_back(nodeIdx);
+                    else
+                        delta[nodeIdx] = 0;
+                }
+            });
+        } else {
+            // Push tainted amounts over outbound edges of the frontier.
+            for (size_t senderIdx : frontier) {
+                for (size_t edgeIdx : nodes_[senderIdx].outbound) {
+                    size_t recipientIdx = edges_[edgeIdx].recipientIdx;
+                    if (isSeed[recipientIdx])
+                        continue;
+
+                    if (!isTouched[recipientIdx]) {
+                        isTouched[recipientIdx] = true;
+                        touched.push_back(recipientIdx);
+                    }
+
+                    taintedInflow[recipientIdx] += delta[senderIdx] * _getEdgeTransactionAmount(edgeIdx);
+                }
+            }
+
+            for (size_t nodeIdx : frontier)
+                delta[nodeIdx] = 0;
+
+            for (size_t nodeIdx : touched) {
+                double newTaint = min(1.0, taintedInflow[nodeIdx] / max(inflow[nodeIdx], 1.0));
+
+                if (newTaint - taint[nodeIdx] > threshold) {
+                    delta[nodeIdx] = newTaint - taint[nodeIdx];
+                    threadFrontiers[0].push_back(nodeIdx);
+                }
+
+                taint[nodeIdx] = newTaint;
+                isTouched[nodeIdx] = false;
+            }
+
+            touched.clear();
+        }
+
+        frontier.clear();
+        for (vector<size_t>& threadFrontier : threadFrontiers) {
+            frontier.insert(frontier.end(), threadFrontier.begin(), threadFrontier.end());
+            threadFrontier.clear();
+        }
+    }
+
+    return taint;
+}
+
+long long Graph::_getEdgeTransactionAmount(size_t edgeIdx) const {
+    const Edge& edge = edges_[edgeIdx];
+
+    // Edge weight is stored as 1/(transaction amount)
+    // convert back to original transaction amount.
+    return llround(1.0 / edge.weight);
+}
+
+size_t Graph::_addNode(const string& address) {
+    if (addressExists(address)) {
+        GRAPH_STATS_INCREMENT(STAT_ADD_NODE_HITS);
+        return node_dict_.at(address);
+    }
+
+    GRAPH_STATS_INCREMENT(STAT_ADD_NODE_MISSES);
 
     auto insertedElement = node_dict_.emplace(address, nodes_.size());
     const string& elementAddress = insertedElement.first -> first;
@@ -300,6 +3513,7 @@ size_t Graph::_addEdge(size_t senderIdx, long long amount, size_t recipientIdx)
     for (size_t edgeIdx : senderOutbounds) {
         const Edge& edge = edges_[edgeIdx];
         if (edge.recipientIdx == recipientIdx) {
+            GRAPH_STATS_INCREMENT(STAT_DUPLICATE_EDGES);
             cerr << "WARNING: Multiple edges attempted to be added from "
                  << nodes_[senderIdx].address << " to " 
                  << nodes_[recipientIdx].address << "."
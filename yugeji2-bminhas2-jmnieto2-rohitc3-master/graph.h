@@ -2,10 +2,25 @@
 
 #include <algorithm>
 using std::sort;
+using std::stable_sort;
+using std::partial_sort;
+using std::nth_element;
+using std::find;
+using std::binary_search;
 using std::random_shuffle;
+using std::shuffle;
+using std::unique;
+using std::min;
+using std::max;
+using std::copy;
+using std::equal;
+using std::push_heap;
+using std::pop_heap;
+using std::reverse;
 
 #include <fstream>
 using std::ifstream;
+using std::ofstream;
 using std::getline;
 
 #include <sstream>
@@ -20,8 +35,12 @@ using std::unordered_map;
 #include <vector>
 using std::vector;
 
+#include <atomic>
+using std::atomic;
+
 #include <utility>
 using std::pair;
+using std::move;
 
 #include <iterator>
 using std::iterator;
@@ -31,12 +50,35 @@ using std::forward_iterator_tag;
 using std::queue;
 using std::priority_queue;
 
+#include <functional>
+using std::greater;
+
 #include <math.h>
 using std::stoll;
 
 #include <limits>
 using std::numeric_limits;
 
+#include <random>
+using std::mt19937;
+using std::mt19937_64;
+using std::seed_seq;
+using std::uniform_real_distribution;
+
+#include <map>
+using std::map;
+
+#include <chrono>
+using std::chrono::steady_clock;
+using std::chrono::duration;
+
+#include <unordered_set>
+using std::unordered_set;
+
+#include <cstdint>
+
+#include "writer.h"
+
 /**
  * Repesents cryptocurrency flow as a directed graph, with nodes
  * representing addresses and edges representing transactions.
@@ -50,6 +92,11 @@ private: // constants
 
 public:
 
+    /**
+     * @brief Build empty graph.
+     */
+    Graph();
+
     /**
      * @brief Build graph structure from file.
      * 
@@ -102,6 +149,17 @@ public:
      */
     vector<string> BFS() const;
 
+    /**
+     * @brief Write addresses of nodes in BFS order, one per line.
+     * 
+     * @param writer  Writer to append addresses to.
+     * @return size_t Number of addresses written.
+     * 
+     * Writes each component as soon as it is traversed, straight 
+     * from the nodes, without copying addresses into a vector.
+     */
+    size_t writeBFS(BufferedWriter& writer) const;
+
     /**
      * @brief Get the most likely path of BTC transacted 
      * from sender to recipient in Bitcoin graph.
@@ -113,6 +171,100 @@ public:
      */
     vector<string> mostLikelyPath(const string& senderAddress, const string& recipientAddress) const;
 
+    /**
+     * Most likely path of a query with the amount of each transaction on it.
+     */
+    struct PathWithAmounts {
+        vector<string> addresses;     // Addresses on path, empty if there is none.
+        vector<long long> amounts;    // Amount sent from addresses[i] to addresses[i + 1].
+        long long totalAmount = 0;
+    };
+
+    /**
+     * @brief Get the most likely path of many pairs of addresses.
+     * 
+     * @param queries                  List of pairs of sender and recipient addresses.
+     * @return vector<PathWithAmounts> Path of each pair in the same order, 
+     *                                 same as mostLikelyPath().
+     * 
+     * Pairs sharing a sender are answered by one shortest path search, 
+     * and senders are searched in parallel, each thread reusing its 
+     * search arrays instead of allocating them per search.
+     */
+    vector<PathWithAmounts> mostLikelyPaths(const vector<pair<string, string>>& queries) const;
+
+    /**
+     * @brief Build index for answering whether BTC can flow 
+     * from one address to another without searching the graph.
+     * 
+     * @param labelCount Number of randomized interval labels 
+     *                   assigned to each component.
+     * 
+     * Strongly connected components are condensed into a DAG which 
+     * is labeled with GRAIL-style randomized post-order intervals. 
+     * Index is discarded whenever a transaction is added.
+     */
+    void buildReachabilityIndex(size_t labelCount = 3);
+
+    /**
+     * @brief Checks if there exists a path of transactions 
+     * from sender to recipient.
+     * 
+     * @param senderAddress    Address of sender.
+     * @param recipientAddress Address of recipient.
+     * @return bool            True if recipient is reachable from sender.
+     * 
+     * Answered from reachability index if built, 
+     * otherwise graph is searched from sender.
+     */
+    bool isReachable(const string& senderAddress, const string& recipientAddress) const;
+
+    /**
+     * @brief Build index for finding addresses that share 
+     * most of their counterparties.
+     * 
+     * @param signatureSize Number of MinHash values kept per address.
+     * @param bandCount     Number of LSH bands signatures are split into, 
+     *                      must divide @a signatureSize.
+     * 
+     * Counterparties of an address are the addresses it sent to or 
+     * received from. Addresses land in the same bucket of a band when 
+     * their signatures agree on every row of it, so pairs with Jaccard 
+     * similarity s become candidates with probability 1 - (1 - s^r)^b. 
+     * Index is discarded whenever a transaction is added.
+     */
+    void buildSimilarityIndex(size_t signatureSize = 128, size_t bandCount = 32);
+
+    /**
+     * @brief Get addresses with counterparties most similar 
+     * to those of given address.
+     * 
+     * @param address                       Address to compare against.
+     * @param k                             Maximum number of addresses returned.
+     * @return vector<pair<string, double>> Addresses with their estimated 
+     *                                      Jaccard similarity, most similar first.
+     * 
+     * Only addresses sharing a bucket with @a address are compared. 
+     * Throws if similarity index is not built.
+     */
+    vector<pair<string, double>> getSimilarAddresses(const string& address, size_t k = 10) const;
+
+    /**
+     * @brief Get all pairs of addresses with similar counterparties.
+     * 
+     * @param threshold     Minimum estimated Jaccard similarity of returned pairs.
+     * @param maxBucketSize Buckets with more addresses are skipped, 
+     *                      0 compares every bucket.
+     * @return vector<pair<pair<string, string>, double>> Pairs of addresses 
+     *                      with their estimated Jaccard similarity, most similar first.
+     * 
+     * Candidate pairs are generated in a single pass over the buckets, each 
+     * pair only from the first band it collides in without being skipped. 
+     * Throws if similarity index is not built.
+     */
+    vector<pair<pair<string, string>, double>> getSimilarAddressPairs(double threshold = 0.5, 
+                                                                      size_t maxBucketSize = 1000) const;
+
     /**
      * @brief Get addresses in graph ordered by centrality
      * 
@@ -122,6 +274,432 @@ public:
      */
     vector<pair<string, unsigned int>> getAddressesByCentrality(size_t samplingSize = 0) const;
 
+    /**
+     * Addresses ordered by score, held as node indexes so addresses 
+     * are only looked up when read or written. Must not outlive 
+     * the graph it was ranked from.
+     */
+    class Ranking {
+    public:
+        /**
+         * @brief Get the number of ranked addresses.
+         * 
+         * @return size_t Number of addresses.
+         */
+        size_t size() const;
+
+        /**
+         * @brief Get address at rank.
+         * 
+         * @param rank           Rank, 0 being the highest score.
+         * @return const string& Address, owned by the graph.
+         */
+        const string& getAddress(size_t rank) const;
+
+        /**
+         * @brief Get score of address at rank.
+         * 
+         * @param rank    Rank, 0 being the highest score.
+         * @return double Score.
+         */
+        double getScore(size_t rank) const;
+
+        /**
+         * @brief Write addresses in order of rank, one per line.
+         * 
+         * @param writer Writer to append addresses to.
+         */
+        void write(BufferedWriter& writer) const;
+
+    private:
+        friend class Graph;
+
+        const Graph* graph_ = nullptr;
+        vector<size_t> nodeIdxs_;   // Node of each rank.
+        vector<double> scores_;     // Score of each rank.
+    };
+
+    /**
+     * @brief Get the addresses of highest centrality, without 
+     * copying or sorting addresses.
+     * 
+     * @param samplingSize Number of sampled sources, 0 for every address.
+     * @param k            Number of addresses to rank, 0 for every address.
+     * @return Ranking     Addresses visited by the algorithm, ordered by 
+     *                     centrality with ties broken by insertion order.
+     * 
+     * The top @a k are selected with nth_element in O(V + k log k) and 
+     * a full ranking is sorted in parallel, both on node indexes.
+     */
+    Ranking getCentralityRanking(size_t samplingSize = 0, size_t k = 0) const;
+
+    /**
+     * @brief Get addresses in graph ordered by PageRank, with 
+     * rank flowing along transactions in proportion to amount.
+     * 
+     * @param dampingFactor Probability of following a transaction 
+     *                      instead of jumping to a random address.
+     * @param tolerance     Iteration stops once the total change 
+     *                      in ranks is below tolerance.
+     * @param maxIterations Maximum number of iterations.
+     * @return vector<pair<string, double>> List of addresses with their 
+     *                                      PageRank ordered by PageRank.
+     * 
+     * Rank of addresses without outbound transactions 
+     * is spread evenly over all addresses.
+     */
+    vector<pair<string, double>> getAddressesByPageRank(double dampingFactor = 0.85, double tolerance = 1e-9, 
+                                                        size_t maxIterations = 100) const;
+
+    /**
+     * @brief Get addresses in graph ordered by approximate harmonic centrality, 
+     * the sum of inverse distances to every address reachable from the address.
+     * 
+     * @param registerBits Log2 of HyperLogLog registers per address, 
+     *                     more registers give smaller error.
+     * @param maxDistance  Maximum distance considered, 0 
+     *                     considers all distances.
+     * @return vector<pair<string, double>> List of addresses with their harmonic 
+     *                                      centrality ordered by centrality.
+     */
+    vector<pair<string, double>> getAddressesByHarmonicCentrality(unsigned int registerBits = 6, 
+                                                                  size_t maxDistance = 0) const;
+
+    /**
+     * @brief Get addresses in graph ordered by approximate closeness centrality, 
+     * the inverse of the sum of distances to every address reachable from the address.
+     * 
+     * @param registerBits Log2 of HyperLogLog registers per address.
+     * @param maxDistance  Maximum distance considered, 0 
+     *                     considers all distances.
+     * @return vector<pair<string, double>> List of addresses with their closeness 
+     *                                      centrality ordered by centrality.
+     * 
+     * Addresses that reach no other address have a closeness of 0.
+     */
+    vector<pair<string, double>> getAddressesByClosenessCentrality(unsigned int registerBits = 6, 
+                                                                   size_t maxDistance = 0) const;
+
+    /**
+     * Harmonic and closeness centrality rankings of one HyperBall run.
+     */
+    struct DistanceCentralities {
+        vector<pair<string, double>> harmonic;
+        vector<pair<string, double>> closeness;
+    };
+
+    /**
+     * @brief Get addresses in graph ordered by approximate harmonic and by 
+     * approximate closeness centrality, estimating distances only once.
+     * 
+     * @param registerBits Log2 of HyperLogLog registers per address.
+     * @param maxDistance  Maximum distance considered, 0 
+     *                     considers all distances.
+     * @return DistanceCentralities Both rankings, same as getAddressesByHarmonicCentrality() 
+     *                              and getAddressesByClosenessCentrality().
+     */
+    DistanceCentralities getAddressesByDistanceCentrality(unsigned int registerBits = 6, 
+                                                          size_t maxDistance = 0) const;
+
+    /**
+     * @brief Get approximate neighborhood function of graph.
+     * 
+     * @param registerBits Log2 of HyperLogLog registers per address.
+     * @param maxDistance  Maximum distance considered, 0 
+     *                     considers all distances.
+     * @return vector<double> Element t holds the number of pairs of addresses 
+     *                        where the second is reachable from the first 
+     *                        within t transactions, including each address itself.
+     */
+    vector<double> getNeighborhoodFunction(unsigned int registerBits = 6, size_t maxDistance = 0) const;
+
+    /**
+     * @brief Get addresses in graph ordered by coreness, the largest k such that 
+     * the address is in a subgraph where every address has at least k counterparties.
+     * 
+     * @return vector<pair<string, unsigned int>> List of addresses with their 
+     *                                            coreness ordered by coreness.
+     * 
+     * Counterparties are addresses connected by a transaction in either direction.
+     */
+    vector<pair<string, unsigned int>> getAddressesByCoreness() const;
+
+    /**
+     * @brief Get the k-core of the graph, the subgraph of addresses 
+     * with coreness of at least k and the transactions between them.
+     * 
+     * @param k      Minimum coreness of addresses in subgraph.
+     * @return Graph Subgraph with transactions in original order.
+     */
+    Graph getCore(unsigned int k) const;
+
+    /**
+     * Group of addresses with many or large transactions between them.
+     */
+    struct DenseSubgraph {
+        vector<string> addresses;
+
+        // Total weight of transactions between addresses divided by number of addresses.
+        double density = 0;
+    };
+
+    /**
+     * @brief Get disjoint dense subgraphs of graph, which point to 
+     * coordinated rings of addresses.
+     * 
+     * @param count        Maximum number of subgraphs, each found 
+     *                     after removing the addresses of the previous ones.
+     * @param weighted     If true, transactions weigh their amount in BTC, 
+     *                     otherwise every pair of counterparties weighs 1.
+     * @param epsilon      Approximation slack of peeling.
+     * @param batchPeeling If true, use parallel batch peeling.
+     * @return vector<DenseSubgraph> Subgraphs in the order they were found, 
+     *                               subgraphs without transactions are left out.
+     * 
+     * Greedy peeling repeatedly removes the address of smallest weighted 
+     * degree, taken from a bucket queue with buckets a factor 1 + @a epsilon 
+     * apart, and keeps the densest set seen, a 2(1 + @a epsilon) approximation. 
+     * Batch peeling removes every address with weighted degree at most 
+     * 2(1 + @a epsilon) times the density in parallel rounds, a 
+     * 2(1 + @a epsilon) approximation in O(log n / @a epsilon) rounds.
+     */
+    vector<DenseSubgraph> getDenseSubgraphs(size_t count = 1, bool weighted = true, 
+                                            double epsilon = 0.1, bool batchPeeling = false) const;
+
+    /**
+     * @brief Group addresses into communities of addresses that transact 
+     * mostly with each other, using parallel Louvain modularity optimization.
+     * 
+     * @param maxLevels Maximum number of times communities are 
+     *                  coarsened into nodes and grouped again.
+     * @return vector<pair<string, size_t>> List of addresses with their community id 
+     *                                      ordered by community, community 0 is the largest.
+     * 
+     * Transactions in both directions between two addresses are combined 
+     * into one undirected edge weighted by total BTC transacted.
+     */
+    vector<pair<string, size_t>> getCommunitiesByLouvain(size_t maxLevels = 10) const;
+
+    /**
+     * @brief Group addresses into communities with parallel label propagation, 
+     * faster but coarser than Louvain.
+     * 
+     * @param maxIterations Maximum number of passes over all addresses.
+     * @return vector<pair<string, size_t>> List of addresses with their community id 
+     *                                      ordered by community, community 0 is the largest.
+     * 
+     * Each address repeatedly adopts the community it transacts the most BTC with.
+     */
+    vector<pair<string, size_t>> getCommunitiesByLabelPropagation(size_t maxIterations = 20) const;
+
+    /**
+     * Counts of short cycles and triangles, used 
+     * as a signal for wash trading between addresses.
+     */
+    struct CycleCounts {
+        size_t twoCycles = 0;   // Pairs of addresses sending BTC to each other.
+        size_t threeCycles = 0; // Directed cycles through three addresses.
+        size_t triangles = 0;   // Triangles of addresses ignoring direction.
+    };
+
+    /**
+     * @brief Get number of short cycles and triangles in graph.
+     * 
+     * @return CycleCounts Total counts, each cycle counted once.
+     */
+    CycleCounts getCycleCounts() const;
+
+    /**
+     * @brief Get addresses in short cycles, ordered by the 
+     * number of two and three cycles they are part of.
+     * 
+     * @return vector<pair<string, CycleCounts>> List of addresses in at least one 
+     *                                           cycle or triangle with their counts.
+     */
+    vector<pair<string, CycleCounts>> getAddressesByCycleCount() const;
+
+    /**
+     * @brief Get haircut taint of addresses, the fraction of each address's 
+     * inflow of BTC that traces back to blacklisted addresses.
+     * 
+     * @param blacklist Addresses whose funds are tainted.
+     * @param hopLimit  Maximum number of transactions taint is traced 
+     *                  through, 0 traces until taint stops changing.
+     * @param threshold Changes in taint of an address smaller 
+     *                  than threshold are not propagated further.
+     * @return vector<pair<string, double>> List of addresses with taint above 0 
+     *                                      and their taint ordered by taint, 
+     *                                      blacklisted addresses have a taint of 1.
+     * 
+     * Taint of an address is split over its outbound transactions 
+     * in proportion to their amounts.
+     */
+    vector<pair<string, double>> getAddressesByTaint(const vector<string>& blacklist, size_t hopLimit = 10, 
+                                                     double threshold = 1e-6) const;
+
+    /**
+     * Nearest labeled address of an address and the cost of the path between them.
+     */
+    struct NearestLabel {
+        string labeledAddress;
+        double cost = 0; // Sum of transaction weights, as in mostLikelyPath.
+    };
+
+    /**
+     * @brief Get nearest labeled address of every address, 
+     * searching from all labeled addresses at once.
+     * 
+     * @param labeledAddresses Addresses of known entities, like exchanges.
+     * @param towardLabels     If true, paths lead from each address to a labeled 
+     *                         address, otherwise from a labeled address to each address.
+     * @return vector<pair<string, NearestLabel>> List of addresses connected to a labeled 
+     *                                            address ordered by path cost, labeled 
+     *                                            addresses are their own nearest label.
+     * 
+     * A single multi-source Dijkstra over outbound transactions, or over 
+     * inbound transactions when @a towardLabels is set, so cost is 
+     * O(E log V) however many addresses are labeled.
+     */
+    vector<pair<string, NearestLabel>> getNearestLabeledAddresses(const vector<string>& labeledAddresses, 
+                                                                  bool towardLabels = false) const;
+
+    /**
+     * Maximum amount that can move from a sender to a recipient 
+     * and the transactions limiting it.
+     */
+    struct MaxFlow {
+        long long flow = 0; // Amount in satoshi.
+
+        // Minimum cut, the (sender, recipient) pairs of saturated transactions 
+        // whose amounts sum to the flow. 
+        vector<pair<string, string>> cutTransactions;
+    };
+
+    /**
+     * @brief Get maximum amount of BTC that can move from sender to recipient, 
+     * with transaction amounts as capacities.
+     * 
+     * @param senderAddress    Address BTC is sent from.
+     * @param recipientAddress Address BTC should reach.
+     * @param hopLimit         If positive, only addresses on a path of at most 
+     *                         @a hopLimit transactions from sender to recipient are 
+     *                         used, giving a lower bound on the flow of the full graph.
+     * @return MaxFlow         Flow from sender to recipient and the minimum cut 
+     *                         closest to recipient, 0 if either address is missing.
+     * 
+     * Uses FIFO push-relabel with global relabeling and the gap heuristic, 
+     * over only the addresses that lie on a path from sender to recipient.
+     */
+    MaxFlow getMaxFlow(const string& senderAddress, const string& recipientAddress, size_t hopLimit = 0) const;
+
+    /**
+     * Chain of addresses each forwarding most of the BTC they send to 
+     * the next address and peeling off the rest to other addresses.
+     */
+    struct PeelChain {
+        vector<string> addresses;
+        long long amount = 0;       // Satoshi forwarded by first address.
+        long long peeledAmount = 0; // Satoshi sent off the chain by its addresses.
+    };
+
+    /**
+     * @brief Get peel chains in graph, ordered by length and then amount.
+     * 
+     * @param minLength      Minimum number of transactions in reported chains.
+     * @param minAmount      Minimum satoshi forwarded by first address of reported chains.
+     * @param dominanceRatio Minimum fraction of the BTC an address sends that 
+     *                       must go to a single recipient to continue a chain.
+     * @return vector<PeelChain> Chains starting at addresses no chain continues into. 
+     *                           Chains stop before revisiting an address.
+     * 
+     * Dominant recipients are found in parallel and chain tails are 
+     * memoized, so every transaction is visited once.
+     */
+    vector<PeelChain> getPeelChains(size_t minLength = 3, long long minAmount = 0, double dominanceRatio = 0.8) const;
+
+    /**
+     * Result of simulating satoshis flowing from a sender.
+     */
+    struct SatoshiFlow {
+        double reachProbability = 0; // Fraction of satoshis reaching recipient.
+        double walksPerSecond = 0;   // Throughput of simulation.
+
+        // Most frequent loop-free paths to recipient, with the 
+        // fraction of satoshis reaching recipient that took each path.
+        vector<pair<vector<string>, double>> paths;
+    };
+
+    /**
+     * @brief Estimate how satoshis sent by sender reach recipient by simulating 
+     * random walks that follow transactions in proportion to their amounts.
+     * 
+     * @param senderAddress    Address satoshis are sent from.
+     * @param recipientAddress Address satoshis should reach.
+     * @param walkCount        Number of satoshis simulated.
+     * @param maxSteps         Maximum number of transactions followed by each satoshi.
+     * @param pathCount        Maximum number of paths returned.
+     * @param seed             Seed of random walks, the same seed gives 
+     *                         the same result on any number of threads.
+     * @return SatoshiFlow     Probability of reaching recipient and most frequent paths.
+     * 
+     * Satoshis stop at addresses without outbound transactions. Loops 
+     * are erased from paths, so each path visits an address at most once.
+     */
+    SatoshiFlow simulateSatoshiFlow(const string& senderAddress, const string& recipientAddress, 
+                                    size_t walkCount = 100000, size_t maxSteps = 100, 
+                                    size_t pathCount = 5, unsigned long long seed = 0) const;
+
+    /**
+     * @brief Write corpus of random walks over transactions for training 
+     * address embeddings with DeepWalk or node2vec.
+     * 
+     * @param filepath        Location of file to write walks to.
+     * @param walksPerAddress Number of walks starting at every address.
+     * @param walkLength      Maximum number of addresses in a walk.
+     * @param p               node2vec return parameter, higher values 
+     *                        make going back to the last address less likely.
+     * @param q               node2vec in-out parameter, higher values keep 
+     *                        walks close to the last address.
+     * @param binary          Write walks as binary instead of text.
+     * @param seed            Seed of random walks.
+     * @return size_t         Number of steps written.
+     * @throws string if p or q is not positive, or file cannot be written.
+     * 
+     * Each step follows an outbound transaction in proportion to its amount, 
+     * biased by p and q through rejection sampling. Walks end early at 
+     * addresses without outbound transactions.
+     * 
+     * Text walks are written one per line as addresses separated by spaces. 
+     * Binary walks are written as a 32 bit length followed by 32 bit address 
+     * ids, with the address of every id written one per line to filepath + ".vocab".
+     */
+    size_t writeRandomWalks(const string& filepath, size_t walksPerAddress = 10, size_t walkLength = 80, 
+                            double p = 1, double q = 1, bool binary = false, 
+                            unsigned long long seed = 0) const;
+
+    /**
+     * @brief Get addresses most exposed to BTC sent from seed addresses 
+     * through approximate personalized PageRank.
+     * 
+     * @param seedAddresses       Addresses that funds are traced from.
+     * @param k                   Maximum number of addresses returned.
+     * @param residualThreshold   Residual rank per outbound transaction 
+     *                            below which rank is no longer pushed, larger 
+     *                            values trade accuracy for speed.
+     * @param teleportProbability Probability of funds stopping at each address.
+     * @return vector<pair<string, double>> Up to k addresses, excluding seeds, with 
+     *                                      their exposure ordered by exposure.
+     * @throws string if residualThreshold is not positive, or teleportProbability 
+     *                is not in (0, 1].
+     * 
+     * Uses the Andersen-Chung-Lang forward push method, so only the neighborhood 
+     * reached by pushed rank is touched. Rank is pushed along transactions in 
+     * proportion to amount and stays at addresses without outbound transactions.
+     */
+    vector<pair<string, double>> getExposedAddresses(const vector<string>& seedAddresses, size_t k = 10, 
+                                                     double residualThreshold = 1e-6, 
+                                                     double teleportProbability = 0.15) const;
+
     /**
      * @brief Get the balance of BTC address based on 
      * transactions inputted into graph.
@@ -153,6 +731,40 @@ public:
      */
     size_t getTransactionCount() const;
 
+    /**
+     * Heap memory held by one data structure of the graph.
+     */
+    struct MemoryUsageEntry {
+        string name;
+        size_t bytes = 0;          // Bytes requested from the heap, including slack.
+        size_t allocations = 0;    // Heap blocks held.
+        size_t slackBytes = 0;     // Bytes of vectors past their size, left by growth.
+    };
+
+    /**
+     * Heap memory held by the graph, by data structure.
+     */
+    struct MemoryUsage {
+        vector<MemoryUsageEntry> entries;
+        size_t bytes = 0;
+        size_t allocations = 0;
+        size_t slackBytes = 0;
+    };
+
+    /**
+     * @brief Estimate heap memory held by the graph and its indexes.
+     * 
+     * @return MemoryUsage Bytes, allocations and slack of every data 
+     *                     structure, and their totals.
+     * 
+     * Counts the bytes requested from the heap, not the bookkeeping 
+     * of the allocator. Strings short enough to be stored inline hold 
+     * no heap memory, and hash table entries are counted as a next 
+     * pointer, the cached hash and the key and value, as both libc++ 
+     * and libstdc++ store them.
+     */
+    MemoryUsage memoryUsage() const;
+
 private:
 
     struct Edge {
@@ -175,14 +787,64 @@ private:
         Node(const string& address, size_t index) : address(address), index(index) { }
     };
 
+    struct SearchWorkspace {
+        vector<double> distance;           // Distance of each node from source.
+        vector<size_t> predecessorEdge;    // Edge into each node on its shortest path, edge count if none.
+        vector<size_t> reached;            // Nodes given a distance by last search.
+        vector<size_t> queue;              // Heap of nodes to visit.
+    };
+
+    struct AliasTable {
+        // Outbound edges of node v are sampled from entries [offsets[v], offsets[v + 1]).
+        vector<size_t> offsets;
+        vector<size_t> recipients;
+
+        // Probability of keeping each entry, otherwise its alias entry is taken.
+        vector<double> probability;
+        vector<size_t> alias;
+    };
+
+    struct ReachabilityIndex {
+        bool built = false;
+        size_t labelCount = 0;
+
+        // Strongly connected component of each node. Components are numbered 
+        // in reverse topological order so successors have smaller ids.
+        vector<size_t> component;
+
+        // Length of longest path from a root component to each component.
+        vector<size_t> level;
+
+        // Successor components of each component in condensed DAG, 
+        // successors of component c are in [successorOffsets[c], successorOffsets[c + 1]).
+        vector<size_t> successorOffsets;
+        vector<size_t> successors;
+
+        // Post-order intervals, labelCount per component.
+        vector<size_t> labelLows;
+        vector<size_t> labelHighs;
+    };
+
+    struct SimilarityIndex {
+        bool built = false;
+        size_t signatureSize = 0;
+        size_t bandCount = 0;
+
+        // MinHash signature of node v is in [v * signatureSize, (v + 1) * signatureSize).
+        vector<uint32_t> signatures;
+
+        // Nodes of each band bucketed by hash of their rows in that band.
+        vector<unordered_map<uint64_t, vector<size_t>>> buckets;
+    };
+
     /**
      * @brief Helper function for traversing component in graph in BFS order.
      * 
      * @param startNodeIdx Index of starter node in component in @a nodes_ list.
-     * @param addresses    List of addresses traversed in BFS order.
+     * @param order        List to append indexes of nodes traversed in BFS order to.
      * @param visitedNodes List indicating visited nodes in graph.
      */
-    void _BFS(size_t startNodeIdx, vector<string>& addresses, vector<bool>& visitedNodes) const;
+    void _BFS(size_t startNodeIdx, vector<size_t>& order, vector<bool>& visitedNodes) const;
 
     /**
      * @brief Get all shortest paths from source node 
@@ -194,6 +856,123 @@ private:
      */
     vector<const Node*> _dijkstraSSSP(size_t nodeIdx) const;
 
+    /**
+     * @brief Get all shortest paths from source node 
+     * using Dijkstra's algorithm, reusing arrays of workspace.
+     * 
+     * @param nodeIdx   Source node index.
+     * @param workspace Arrays of an earlier search from any source, or empty ones. 
+     *                  Only entries reached by that search are reset.
+     */
+    void _dijkstraSSSP(size_t nodeIdx, SearchWorkspace& workspace) const;
+
+    /**
+     * @brief Get path from source of a search to recipient.
+     * 
+     * @param recipientIdx Recipient node index.
+     * @param workspace    Arrays of search from source.
+     * @param path         Set to path and amounts of its transactions, 
+     *                     left empty if recipient was not reached.
+     */
+    void _followPath(size_t recipientIdx, const SearchWorkspace& workspace, PathWithAmounts& path) const;
+
+    /**
+     * @brief Get shortest paths from the nearest of several source nodes.
+     * 
+     * @param sourceIdxs    Indexes of source nodes.
+     * @param reverse       If true, paths are searched over inbound 
+     *                      edges, leading from each node to a source.
+     * @param distance      Cost of path from nearest source of every node.
+     * @param nearestSource Nearest source node of every node, 
+     *                      size of @a nodes_ list if unreachable.
+     */
+    void _multiSourceDijkstra(const vector<size_t>& sourceIdxs, bool reverse, 
+                              vector<double>& distance, vector<size_t>& nearestSource) const;
+
+    /**
+     * @brief Get recipient most of the BTC sent by each node goes to.
+     * 
+     * @param dominanceRatio   Minimum fraction of outbound amount sent to recipient.
+     * @param forwardedAmounts Amount each node sends to its dominant recipient.
+     * @param peeledAmounts    Outbound amount of each node not sent to its dominant recipient.
+     * @return vector<size_t>  Dominant recipient of each node, size of 
+     *                         @a nodes_ list if node has none.
+     */
+    vector<size_t> _getDominantRecipients(double dominanceRatio, vector<long long>& forwardedAmounts, 
+                                          vector<long long>& peeledAmounts) const;
+
+    /**
+     * @brief Get number of edges on the shortest unweighted 
+     * path between start node and every node it reaches.
+     * 
+     * @param startIdx Index of start node in @a nodes_ list.
+     * @param reverse  If true, paths are searched over inbound 
+     *                 edges, leading from each node to start node.
+     * @param hopLimit Maximum number of edges searched, 0 for no limit.
+     * @return unordered_map<size_t, size_t> Map from indexes of reached nodes to their hops.
+     */
+    unordered_map<size_t, size_t> _getHopDistances(size_t startIdx, bool reverse, size_t hopLimit) const;
+
+    /**
+     * @brief Get maximum flow from source node to sink node with push-relabel.
+     * 
+     * @param sourceIdx    Index of source node in @a nodes_ list.
+     * @param sinkIdx      Index of sink node in @a nodes_ list.
+     * @param hopLimit     Maximum length of source to sink paths used, 0 for no limit.
+     * @param cutEdgeIdxs  Indexes of edges in minimum cut, in @a edges_ order.
+     * @return long long   Value of maximum flow.
+     */
+    long long _pushRelabel(size_t sourceIdx, size_t sinkIdx, size_t hopLimit, vector<size_t>& cutEdgeIdxs) const;
+
+    /**
+     * @brief Checks if there exists a path from sender node to recipient node.
+     * 
+     * @param senderIdx    Index of sender node in @a nodes_ list.
+     * @param recipientIdx Index of recipient node in @a nodes_ list.
+     * @return bool        True if recipient node is reachable from sender node.
+     */
+    bool _isReachable(size_t senderIdx, size_t recipientIdx) const;
+
+    /**
+     * @brief Checks if labels of reachability index allow 
+     * a path between two components.
+     * 
+     * @param senderComponent    Component of sender.
+     * @param recipientComponent Component of recipient.
+     * @return bool              False if recipient component is 
+     *                           certainly unreachable, true otherwise.
+     */
+    bool _reachabilityLabelsAllow(size_t senderComponent, size_t recipientComponent) const;
+
+    /**
+     * @brief Get strongly connected components of graph 
+     * using iterative Tarjan's algorithm.
+     * 
+     * @param component List to fill with component of every node.
+     * @return size_t   Number of components, components are 
+     *                  numbered in reverse topological order.
+     */
+    size_t _getStronglyConnectedComponents(vector<size_t>& component) const;
+
+    /**
+     * @brief Helper function for hashing rows of signature in band.
+     * 
+     * @param nodeIdx   Index of node in @a nodes_ list.
+     * @param band      Band of signature.
+     * @return uint64_t Bucket key of node in band.
+     */
+    uint64_t _getBandKey(size_t nodeIdx, size_t band) const;
+
+    /**
+     * @brief Helper function for estimating Jaccard similarity of 
+     * counterparties of two nodes from their signatures.
+     * 
+     * @param lhsIdx  Index of first node in @a nodes_ list.
+     * @param rhsIdx  Index of second node in @a nodes_ list.
+     * @return double Fraction of signature values that agree.
+     */
+    double _estimateSimilarity(size_t lhsIdx, size_t rhsIdx) const;
+
     /**
      * @brief Get the Betweeness Centrality of nodes in the graph.
      * 
@@ -204,6 +983,177 @@ private:
      */
     vector<int> _getBetweenessCentrality(size_t samplingSize) const;
 
+    /**
+     * @brief Get the amount-weighted PageRank of nodes in the graph.
+     * 
+     * @param dampingFactor   Probability of following a transaction.
+     * @param tolerance       Total change in ranks to stop at.
+     * @param maxIterations   Maximum number of iterations.
+     * @return vector<double> PageRank of every node, summing to 1.
+     * 
+     * Each iteration pulls rank over inbound edges in parallel.
+     */
+    vector<double> _getPageRank(double dampingFactor, double tolerance, size_t maxIterations) const;
+
+    /**
+     * @brief Estimate distances from every node with HyperBall, keeping a 
+     * HyperLogLog counter of the nodes reachable within t edges of each node.
+     * 
+     * @param registerBits    Log2 of registers in each counter, clamped to [4, 16].
+     * @param maxDistance     Maximum distance considered, 0 considers all distances.
+     * @param harmonic        List to fill with harmonic centrality of every node.
+     * @param closeness       List to fill with closeness centrality of every node.
+     * @return vector<double> Neighborhood function of graph.
+     * 
+     * Each pass unions the counters of outbound neighbors in parallel 
+     * over nodes, using memory of nodes times registers.
+     */
+    vector<double> _hyperBall(unsigned int registerBits, size_t maxDistance, 
+                              vector<double>& harmonic, vector<double>& closeness) const;
+
+    /**
+     * @brief Get coreness of every node by peeling nodes in 
+     * parallel in order of undirected degree.
+     * 
+     * @return vector<size_t> Coreness of every node.
+     * 
+     * Nodes are kept in buckets by current degree, and all nodes of 
+     * the lowest bucket are removed at once with their neighbors' 
+     * degrees decremented atomically.
+     */
+    vector<size_t> _getCoreness() const;
+
+    /**
+     * @brief Find densest subgraph of weighted undirected graph by peeling.
+     * 
+     * @param offsets      Adjacency offsets of every node.
+     * @param neighbors    Neighbors of every node, without self loops.
+     * @param weights      Weight of edge to every neighbor.
+     * @param excluded     Nodes left out of the graph.
+     * @param epsilon      Approximation slack of peeling.
+     * @param batchPeeling If true, use parallel batch peeling.
+     * @param members      Nodes of densest subgraph found.
+     * @return double      Density of subgraph found.
+     */
+    double _getDensestSubgraph(const vector<size_t>& offsets, const vector<size_t>& neighbors, 
+                               const vector<double>& weights, const vector<char>& excluded, 
+                               double epsilon, bool batchPeeling, vector<size_t>& members) const;
+
+    /**
+     * @brief Count short cycles and triangles in parallel over nodes.
+     * 
+     * @param nodeCounts   List to fill with counts of every node.
+     * @return CycleCounts Total counts of graph.
+     * 
+     * Undirected edges are oriented from lower to higher degree so hubs only 
+     * keep their few higher degree neighbors, and triangles are found by 
+     * SIMD intersection of the sorted oriented neighbor lists.
+     */
+    CycleCounts _countCycles(vector<CycleCounts>& nodeCounts) const;
+
+    /**
+     * @brief Build undirected adjacency lists from outbound and inbound 
+     * edges, without duplicate neighbors or self loops.
+     * 
+     * @param offsets   List to fill with offsets, neighbors of node v are 
+     *                  in [offsets[v], offsets[v + 1]) of @a neighbors.
+     * @param neighbors List to fill with sorted neighbors of every node.
+     * @param weights   If given, list to fill with the total BTC transacted 
+     *                  in both directions with each neighbor.
+     */
+    void _getUndirectedAdjacency(vector<size_t>& offsets, vector<size_t>& neighbors, 
+                                 vector<double>* weights = nullptr) const;
+
+    /**
+     * @brief Get communities of nodes with parallel Louvain 
+     * modularity optimization over BTC amounts transacted.
+     * 
+     * @param maxLevels       Maximum number of coarsening levels.
+     * @return vector<size_t> Community of every node, numbered 
+     *                        from largest to smallest community.
+     */
+    vector<size_t> _getLouvainCommunities(size_t maxLevels) const;
+
+    /**
+     * @brief Get communities of nodes with parallel label propagation 
+     * over BTC amounts transacted.
+     * 
+     * @param maxIterations   Maximum number of passes over all nodes.
+     * @return vector<size_t> Community of every node, numbered 
+     *                        from largest to smallest community.
+     */
+    vector<size_t> _getLabelPropagationCommunities(size_t maxIterations) const;
+
+    /**
+     * @brief Pair every node's address with its community, 
+     * ordered by community.
+     * 
+     * @param community Community of every node.
+     * @return vector<pair<string, size_t>> List of addresses with their community.
+     */
+    vector<pair<string, size_t>> _listCommunities(const vector<size_t>& community) const;
+
+    /**
+     * @brief Get haircut taint of every node by propagating changes 
+     * in taint from seed nodes one hop at a time.
+     * 
+     * @param seedIdxs        Indexes of tainted nodes.
+     * @param hopLimit        Maximum number of hops, 0 for no limit.
+     * @param threshold       Minimum change in taint propagated further.
+     * @return vector<double> Taint of every node in [0, 1].
+     * 
+     * Small frontiers push along outbound edges, large frontiers 
+     * pull over inbound edges of every node in parallel.
+     */
+    vector<double> _getTaint(const vector<size_t>& seedIdxs, size_t hopLimit, double threshold) const;
+
+    /**
+     * @brief Build alias tables for sampling outbound edges of 
+     * every node in proportion to transaction amount in O(1).
+     * 
+     * @param table Alias table to fill, built in parallel over nodes 
+     *              with Vose's alias method.
+     */
+    void _buildAliasTable(AliasTable& table) const;
+
+    /**
+     * @brief Sample outbound edge of node from alias table.
+     * 
+     * @param table     Alias table of graph.
+     * @param nodeIdx   Index of node to sample from.
+     * @param generator Random number generator.
+     * @return size_t   Index of sampled recipient node, or size of 
+     *                  @a nodes_ list if node has no outbound edges.
+     */
+    size_t _sampleOutbound(const AliasTable& table, size_t nodeIdx, mt19937_64& generator) const;
+
+    /**
+     * @brief Build flat arrays of inbound edges of every node.
+     * 
+     * @param offsets Inbound edges of node v are in [offsets[v], offsets[v + 1]).
+     * @param senders List to fill with sender of every inbound edge.
+     * @param amounts List to fill with amount in satoshis of every inbound edge.
+     */
+    void _getInboundAdjacency(vector<size_t>& offsets, vector<size_t>& senders, vector<double>& amounts) const;
+
+    /**
+     * @brief Pair every node's address with its score, 
+     * sorted by score in descending order.
+     * 
+     * @param scores Score of every node.
+     * @return vector<pair<string, double>> List of addresses with their score.
+     */
+    vector<pair<string, double>> _rankAddresses(const vector<double>& scores) const;
+
+    /**
+     * @brief Rank nodes by score on their indexes.
+     * 
+     * @param scores   Score of every node, nodes with negative scores are left out.
+     * @param k        Number of nodes to rank, 0 for every node.
+     * @return Ranking Top @a k nodes ordered by score, ties broken by index.
+     */
+    Ranking _rankNodes(const vector<double>& scores, size_t k) const;
+
     /**
      * @brief Get the original transaction amount in satoshis from edge.
      * 
@@ -252,4 +1202,10 @@ private:
     // Map, mapping BTC Addresses to Node indexes in nodes_ list.
     unordered_map<string, size_t> node_dict_;
 
+    // Index for reachability queries, built on request.
+    ReachabilityIndex reachability_;
+
+    // Index for similarity queries, built on request.
+    SimilarityIndex similarity_;
+
 };
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "heap.h"
+
+#ifdef GRAPH_COUNT_ALLOCATIONS
+
+#include <atomic>
+using std::atomic;
+
+#include <cstdlib>
+#include <new>
+
+static atomic<size_t> allocatedBytes(0);
+static atomic<size_t> allocationCount(0);
+
+// Size of every block is stored in front of it, keeping the alignment of malloc.
+static const size_t HEADER_SIZE = alignof(std::max_align_t);
+
+void* operator new(size_t size) {
+    void* block = malloc(size + HEADER_SIZE);
+    if (!block)
+        throw std::bad_alloc();
+
+    *(size_t*) block = size;
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    return (char*) block + HEADER_SIZE;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    if (!pointer)
+        return;
+
+    void* block = (char*) pointer - HEADER_SIZE;
+    allocatedBytes.fetch_sub(*(size_t*) block, std::memory_order_relaxed);
+    allocationCount.fetch_sub(1, std::memory_order_relaxed);
+
+    free(block);
+}
+
+void operator delete[](void* pointer) noexcept {
+    operator delete(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    operator delete(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    operator delete(pointer);
+}
+
+bool heapCountingEnabled() {
+    return true;
+}
+
+HeapUsage getHeapUsage() {
+    HeapUsage usage;
+    usage.bytes = allocatedBytes.load();
+    usage.allocations = allocationCount.load();
+    return usage;
+}
+
+#else
+
+bool heapCountingEnabled() {
+    return false;
+}
+
+HeapUsage getHeapUsage() {
+    return HeapUsage();
+}
+
+#endif
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Heap memory currently allocated through operator new.
+ */
+struct HeapUsage {
+    size_t bytes = 0;
+    size_t allocations = 0;
+};
+
+/**
+ * @brief Check if heap allocations are counted, that is 
+ * if compiled with GRAPH_COUNT_ALLOCATIONS.
+ * 
+ * @return bool True if allocations are counted.
+ */
+bool heapCountingEnabled();
+
+/**
+ * @brief Get heap memory currently allocated by all threads.
+ * 
+ * @return HeapUsage Bytes requested and blocks not yet freed,
+ *                   zero if allocations are not counted.
+ * 
+ * Counting replaces the global operator new and delete to validate 
+ * estimates like Graph::memoryUsage() against real heap usage.
+ */
+HeapUsage getHeapUsage();
@@ -1,4 +1,5 @@
 #include <fstream>
+using std::ifstream;
 using std::ofstream;
 using std::getline;
 
@@ -9,17 +10,50 @@ using std::vector;
 using std::cout;
 using std::endl;
 using std::cin;
+using std::ws;
 
 #include <string>
 using std::string;
 using std::to_string;
+using std::stoul;
+using std::stod;
+
+#include <sstream>
+using std::stringstream;
 
 #include <utility>
 using std::pair;
 
+#include <unordered_map>
+using std::unordered_map;
+
+#include <algorithm>
+using std::max;
+
+#include <chrono>
+using std::chrono::steady_clock;
+using std::chrono::duration;
+
+#include <memory>
+using std::unique_ptr;
+
+#include <stdexcept>
+
+#include <cctype>
+#include <climits>
+#include <csignal>
+
 #include <dirent.h>
 
 #include "graph.h"
+#include "generator.h"
+#include "stats.h"
+#include "perf.h"
+#include "trace.h"
+#include "heap.h"
+#include "writer.h"
+#include "server.h"
+#include "parallel.h"
 
 /**
  * @brief Write strings in vector to file.
@@ -28,27 +62,99 @@ using std::pair;
  * @param filename Filename to input strings into.
  */
 void writeVectorToFile(const vector<string>& v, const string& filename) {
-  ofstream file;
-  file.open(filename);
+  TraceSpan span("write file", "output");
+  BufferedWriter file(filename);
   for (const string& str : v) {
-    file << str << "\n";
+    file.writeLine(str);
+  }
+  file.close();
+}
+
+/**
+ * @brief Write addresses of ranking to file in order, 
+ * without copying them out of the ranking first.
+ * 
+ * @param ranking  List of addresses with their score.
+ * @param filename Filename to write addresses into.
+ */
+template <typename Score>
+void writeRankingToFile(const vector<pair<string, Score>>& ranking, const string& filename) {
+  TraceSpan span("write file", "output");
+  BufferedWriter file(filename);
+  for (const auto& rank : ranking) {
+    file.writeLine(rank.first);
   }
   file.close();
 }
 
+/**
+ * @brief Parse whole argument as an unsigned number, unlike stoul 
+ * which ignores trailing characters and wraps negative numbers.
+ * 
+ * @param value          Argument to parse.
+ * @param max            Largest number accepted, so it fits its destination.
+ * @return unsigned long Number.
+ * @throws std::invalid_argument if argument is not an unsigned number.
+ * @throws std::out_of_range if number is larger than max.
+ */
+unsigned long parseUnsigned(const string& value, unsigned long max = ULONG_MAX) {
+  if (value.empty() || !isdigit((unsigned char) value[0]))
+    throw std::invalid_argument(value);
+
+  size_t length = 0;
+  unsigned long number = stoul(value, &length);
+  if (length != value.size())
+    throw std::invalid_argument(value);
+  if (number > max)
+    throw std::out_of_range(value);
+
+  return number;
+}
+
+/**
+ * @brief Read non-empty lines of file into vector.
+ * 
+ * @param filename        Filename to read lines from.
+ * @return vector<string> List of lines in file.
+ * @throws string if file does not exist.
+ */
+vector<string> readVectorFromFile(const string& filename) {
+  ifstream file(filename);
+  if (!file.is_open())
+    throw string("File \"" + filename + "\" does not exist!");
+
+  vector<string> v;
+  string line;
+  while (getline(file, line)) {
+    // Removes whitespace and carriage returns.
+    stringstream ss(line);
+    if (ss >> line)
+      v.push_back(line);
+  }
+
+  return v;
+}
+
 /**
  * @brief Demonstration of Breadth First Search (BFS) traversal over 
  * graph of Bitcoin transactions.
  * 
- * @param g Graph.
+ * @param g            Graph.
+ * @param perfCounters Counters to profile traversal with, if not null.
  */
-void BFSDemo(const Graph& g, const string& outputDir) {
+void BFSDemo(const Graph& g, const string& outputDir, PerfCounters* perfCounters) {
   cout << "BFS Demo \n" << endl;
 
   string filename = outputDir + "/BFSDemo.txt";
 
   cout << "Traversing graph in BFS order..." << endl;
-  writeVectorToFile(g.BFS(), filename);
+  {
+    // Addresses are written by a background thread while traversal continues.
+    PerfPhase phase(perfCounters, "BFS", g.getTransactionCount());
+    BufferedWriter file(filename, true);
+    g.writeBFS(file);
+    file.close();
+  }
   cout << "Traversal outputted to " << filename << "\n" << endl;
 }
 
@@ -56,7 +162,8 @@ void BFSDemo(const Graph& g, const string& outputDir) {
  * @brief Demonstration of Dijkstra's shortest path algorithm 
  * on graph of Bitcoin transactions.
  * 
- * @param g Graph.
+ * @param g            Graph.
+ * @param perfCounters Counters to profile search with, if not null.
  * 
  * Estimates the path that a satoshi is 'most likely' to take to travel from 
  * a given sender to a given recipient. Please refer to the readme for more details.
@@ -71,7 +178,7 @@ void BFSDemo(const Graph& g, const string& outputDir) {
  *  Sender: 1PQA36EPu9YM4toTihagJuskmJ1WgPuyJ2
  *  Recipient: 16w7NznT6V7qSb22ZsadTHgJ7xxJVRGxRj
  */
-void mostLikelyPathDemo(const Graph& g, const string& outputDir) {
+void mostLikelyPathDemo(const Graph& g, const string& outputDir, PerfCounters* perfCounters) {
   cout << "Shortest Path Demo \n" << endl;
 
   string filename = outputDir + "/pathDemo.txt";
@@ -88,7 +195,11 @@ void mostLikelyPathDemo(const Graph& g, const string& outputDir) {
   getline(cin, recipientAddress);
 
   cout << "Getting shortest path with most bitcoin transacted..." << endl;
-  vector<string> path = g.mostLikelyPath(senderAddress, recipientAddress);
+  vector<string> path;
+  {
+    PerfPhase phase(perfCounters, "most likely path", g.getTransactionCount());
+    path = g.mostLikelyPath(senderAddress, recipientAddress);
+  }
   writeVectorToFile(path, filename);
   cout << "Path outputted to " << filename << "\n" << endl;
   cout << "Gettings stats on path..." << endl;
@@ -106,11 +217,180 @@ void mostLikelyPathDemo(const Graph& g, const string& outputDir) {
        << senderAddress << " to " << recipientAddress << "\n" << endl;
 }
 
+/**
+ * @brief Demonstration of the most likely path of many pairs of 
+ * addresses read from file.
+ * 
+ * @param g               Graph.
+ * @param outputDir       Directory to write paths into.
+ * @param queriesFilepath File with one sender and recipient address per line, 
+ *                        separated by a comma.
+ * 
+ * Each line of the output has the sender, recipient, number of transactions 
+ * in the path and total satoshis transacted, followed by the path alternating 
+ * addresses and the satoshis sent to the next address. Lines are in the order 
+ * of the queries, and only have the first four fields when there is no path.
+ */
+void pathQueriesDemo(const Graph& g, const string& outputDir, const string& queriesFilepath) {
+  cout << "Path Queries Demo \n" << endl;
+
+  string filename = outputDir + "/pathQueries.txt";
+
+  ifstream file(queriesFilepath);
+  if (!file.is_open())
+    throw string("File \"" + queriesFilepath + "\" does not exist!");
+
+  vector<pair<string, string>> queries;
+  string line;
+  while (getline(file, line)) {
+    // Removes whitespace and carriage returns around addresses.
+    string sender, recipient;
+    stringstream ss(line);
+    getline(ss >> ws, sender, ',');
+    ss >> recipient;
+
+    if (sender.empty())
+      continue;
+
+    while (!sender.empty() && isspace((unsigned char) sender.back()))
+      sender.pop_back();
+
+    if (recipient.empty())
+      throw string("Line \"" + line + "\" of \"" + queriesFilepath + "\" is not a pair of addresses!");
+
+    queries.emplace_back(sender, recipient);
+  }
+
+  cout << "Getting shortest paths with most bitcoin transacted for " << queries.size() << " pairs..." << endl;
+
+  steady_clock::time_point start = steady_clock::now();
+  vector<Graph::PathWithAmounts> paths = g.mostLikelyPaths(queries);
+  duration<double> elapsed = steady_clock::now() - start;
+
+  size_t pathCount = 0;
+  {
+    TraceSpan span("write file", "output");
+    BufferedWriter file(filename);
+
+    for (size_t queryIdx = 0; queryIdx < queries.size(); ++queryIdx) {
+      const Graph::PathWithAmounts& path = paths[queryIdx];
+      pathCount += !path.addresses.empty();
+
+      file.write(queries[queryIdx].first + "," + queries[queryIdx].second + ",");
+      file.writeNumber(path.amounts.size());
+      file.write("," + to_string(path.totalAmount));
+
+      for (size_t i = 0; i < path.addresses.size(); ++i) {
+        file.write("," + path.addresses[i]);
+        if (i < path.amounts.size())
+          file.write("," + to_string(path.amounts[i]));
+      }
+      file.put('\n');
+    }
+
+    file.close();
+  }
+
+  cout << "Found " << pathCount << " paths in " << elapsed.count() << " seconds (" 
+       << queries.size() / max(elapsed.count(), 1e-9) << " pairs per second)" << endl;
+  cout << "Paths outputted to " << filename << "\n" << endl;
+}
+
+/**
+ * @brief Demonstration of Monte Carlo simulation of satoshis 
+ * flowing through graph of Bitcoin transactions.
+ * 
+ * @param g Graph.
+ * 
+ * Each simulated satoshi follows outbound transactions chosen in proportion 
+ * to their amounts, estimating the probability that a satoshi sent by the 
+ * sender reaches the recipient and the paths it most likely takes.
+ */
+void satoshiFlowDemo(const Graph& g, const string& outputDir) {
+  cout << "Satoshi Flow Demo \n" << endl;
+
+  string filename = outputDir + "/satoshiFlowDemo.txt";
+  string senderAddress, recipientAddress;
+
+  cout << "Input two addresses from /" + outputDir + "/transactions.csv" << endl;
+
+  // Get sender address
+  cout << "Sender Bitcoin Address: ";
+  getline(cin >> ws, senderAddress);
+
+  // Get recipient address
+  cout << "Recipient Bitcoin Address: "; 
+  getline(cin >> ws, recipientAddress);
+
+  cout << "Simulating satoshis sent from sender..." << endl;
+  Graph::SatoshiFlow flow = g.simulateSatoshiFlow(senderAddress, recipientAddress);
+
+  vector<string> pathLines;
+  for (const auto& path : flow.paths) {
+    string line = to_string(path.second);
+    for (const string& address : path.first)
+      line += "," + address;
+    pathLines.push_back(line);
+  }
+
+  writeVectorToFile(pathLines, filename);
+  cout << "Most frequent paths outputted to " << filename << "\n" << endl;
+
+  cout << "A satoshi sent from " << senderAddress << " reaches " << recipientAddress 
+       << " with probability " << flow.reachProbability 
+       << " (" << flow.walksPerSecond << " walks per second)\n" << endl;
+}
+
+/**
+ * @brief Demonstration of maximum flow between two addresses 
+ * in graph of Bitcoin transactions.
+ * 
+ * @param g        Graph.
+ * @param hopLimit Maximum length of paths used, 0 for no limit.
+ * 
+ * Unlike the single most likely path, the maximum flow counts BTC 
+ * moving over every path, and the minimum cut lists the transactions 
+ * limiting it.
+ */
+void maxFlowDemo(const Graph& g, const string& outputDir, size_t hopLimit) {
+  cout << "Max Flow Demo \n" << endl;
+
+  string filename = outputDir + "/minCut.txt";
+  string senderAddress, recipientAddress;
+
+  cout << "Input two addresses from /" + outputDir + "/transactions.csv" << endl;
+
+  // Get sender address
+  cout << "Sender Bitcoin Address: ";
+  getline(cin >> ws, senderAddress);
+
+  // Get recipient address
+  cout << "Recipient Bitcoin Address: "; 
+  getline(cin >> ws, recipientAddress);
+
+  cout << "Getting maximum flow from sender to recipient..." << endl;
+  Graph::MaxFlow maxFlow = g.getMaxFlow(senderAddress, recipientAddress, hopLimit);
+
+  vector<string> cutLines;
+  for (const auto& transaction : maxFlow.cutTransactions)
+    cutLines.push_back(transaction.first + "," 
+                       + to_string(g.getTransactionAmount(transaction.first, transaction.second)) + "," 
+                       + transaction.second);
+
+  writeVectorToFile(cutLines, filename);
+  cout << "Transactions in minimum cut outputted to " << filename << "\n" << endl;
+
+  cout << "Up to " << g.convertSatoshiToBTC(maxFlow.flow) << " BTC can flow from " 
+       << senderAddress << " to " << recipientAddress << ", limited by " 
+       << maxFlow.cutTransactions.size() << " transactions\n" << endl;
+}
+
 /**
  * @brief Demonstration of betweeness centrality algorithm on 
  * graph of Bitcoin transactions.
  * 
- * @param g Graph.
+ * @param g            Graph.
+ * @param perfCounters Counters to profile algorithm with, if not null.
  * 
  * Centrality is calculated using shortest path, dijkstra's, algorithm 
  * in the graph over every node by the amount of paths each 
@@ -119,7 +399,7 @@ void mostLikelyPathDemo(const Graph& g, const string& outputDir) {
  * Algorithm is expensive so sampling is 
  * sometimes required for large datasets.
  */
-void centralityDemo(const Graph& g, const string& outputDir) {
+void centralityDemo(const Graph& g, const string& outputDir, PerfCounters* perfCounters) {
   cout << "Centrality Demo \n" << endl;
 
   string filename;
@@ -135,37 +415,611 @@ void centralityDemo(const Graph& g, const string& outputDir) {
   cout << "Getting addresses by centrality with sample size " 
        << sampleSize << "..." << endl;
 
-  vector<pair<string, unsigned int>> centralities = g.getAddressesByCentrality(sampleSize);
-  vector<string> addressesByCentrality;
+  // Every sampled address searches the whole graph.
+  size_t searchCount = sampleSize == 0 || sampleSize > g.getAddressCount() ? g.getAddressCount() : sampleSize;
 
-  for (const auto& centrality : centralities)
-    addressesByCentrality.push_back(centrality.first);
-
-  writeVectorToFile(addressesByCentrality, filename);
+  Graph::Ranking centralities;
+  {
+    PerfPhase phase(perfCounters, "betweenness centrality", searchCount * g.getTransactionCount());
+    centralities = g.getCentralityRanking(sampleSize);
+  }
+  {
+    TraceSpan span("write file", "output");
+    BufferedWriter file(filename);
+    centralities.write(file);
+    file.close();
+  }
   cout << "Addresses listed by centrality outputted to " << filename << "\n" << endl;
 
   cout << "Top 10 addresses with their balance and centrality score in graph:\n" << endl;
   for (size_t i = 0; i < 10 && i < centralities.size(); ++i) 
     cout << i + 1 << ". " 
-         << centralities[i].first // Address
-         << " (" << g.convertSatoshiToBTC(g.getAddressBalance(centralities[i].first)) << " BTC)" // Balance
-         << " (" << centralities[i].second << ")" // Score
+         << centralities.getAddress(i) // Address
+         << " (" << g.convertSatoshiToBTC(g.getAddressBalance(centralities.getAddress(i))) << " BTC)" // Balance
+         << " (" << (unsigned long long) centralities.getScore(i) << ")" // Score
+         << endl;
+}
+
+/**
+ * @brief Write addresses in order of ranking to file and print 
+ * the top 10 addresses with their balance and score.
+ * 
+ * @param g         Graph.
+ * @param ranking   List of addresses with their score ordered by score.
+ * @param filename  Filename to write addresses into.
+ * @param scoreName Name of score printed with top addresses.
+ */
+void outputRanking(const Graph& g, const vector<pair<string, double>>& ranking, 
+                   const string& filename, const string& scoreName) {
+  writeRankingToFile(ranking, filename);
+  cout << "Addresses listed by " << scoreName << " outputted to " << filename << "\n" << endl;
+
+  cout << "Top 10 addresses with their balance and " << scoreName << " in graph:\n" << endl;
+  for (size_t i = 0; i < 10 && i < ranking.size(); ++i) 
+    cout << i + 1 << ". " 
+         << ranking[i].first // Address
+         << " (" << g.convertSatoshiToBTC(g.getAddressBalance(ranking[i].first)) << " BTC)" // Balance
+         << " (" << ranking[i].second << ")" // Score
+         << endl;
+}
+
+/**
+ * @brief Demonstration of amount-weighted PageRank on 
+ * graph of Bitcoin transactions.
+ * 
+ * @param g Graph.
+ * 
+ * Rank flows along transactions in proportion to the amount sent, 
+ * so addresses receiving large amounts from well ranked addresses 
+ * rank highest. Much cheaper than betweenness centrality, 
+ * so no sampling is needed.
+ */
+void pageRankDemo(const Graph& g, const string& outputDir) {
+  cout << "PageRank Demo \n" << endl;
+
+  cout << "Getting addresses by PageRank..." << endl;
+  outputRanking(g, g.getAddressesByPageRank(), outputDir + "/pageRank.txt", "PageRank");
+}
+
+/**
+ * @brief Demonstration of approximate harmonic and closeness 
+ * centrality on graph of Bitcoin transactions.
+ * 
+ * @param g Graph.
+ * 
+ * Distances are estimated with HyperLogLog counters of the addresses 
+ * reachable from every address, taking a few linear passes over 
+ * the graph instead of a shortest path search from every address.
+ */
+void distanceCentralityDemo(const Graph& g, const string& outputDir) {
+  cout << "Harmonic and Closeness Centrality Demo \n" << endl;
+
+  cout << "Getting addresses by harmonic and closeness centrality..." << endl;
+  Graph::DistanceCentralities centralities = g.getAddressesByDistanceCentrality();
+
+  outputRanking(g, centralities.harmonic, outputDir + "/harmonicCentrality.txt", "harmonic centrality");
+  cout << endl;
+  outputRanking(g, centralities.closeness, outputDir + "/closenessCentrality.txt", "closeness centrality");
+}
+
+/**
+ * @brief Demonstration of personalized PageRank on graph of Bitcoin 
+ * transactions, finding addresses most exposed to funds from seed addresses.
+ * 
+ * @param g Graph.
+ * 
+ * Only the neighborhood that funds from the seeds reach is explored, 
+ * so the demo is cheap even on large graphs.
+ */
+void exposureDemo(const Graph& g, const string& outputDir) {
+  cout << "Exposure Demo \n" << endl;
+
+  string filename = outputDir + "/exposureDemo.txt";
+  string seedLine, seedAddress;
+  vector<string> seedAddresses;
+
+  cout << "Input seed addresses separated by spaces from /" + outputDir + "/transactions.csv" << endl;
+  cout << "Seed Bitcoin Addresses: ";
+  getline(cin >> ws, seedLine);
+
+  stringstream ss(seedLine);
+  while (ss >> seedAddress)
+    seedAddresses.push_back(seedAddress);
+
+  cout << "Getting addresses most exposed to funds from seed addresses..." << endl;
+
+  vector<pair<string, double>> exposures = g.getExposedAddresses(seedAddresses, 100);
+  vector<string> exposureLines;
+
+  for (const auto& exposure : exposures)
+    exposureLines.push_back(exposure.first + "," + to_string(exposure.second));
+
+  writeVectorToFile(exposureLines, filename);
+  cout << "Exposed addresses outputted to " << filename << "\n" << endl;
+
+  cout << "Top 10 addresses with their exposure to seed addresses:\n" << endl;
+  for (size_t i = 0; i < 10 && i < exposures.size(); ++i) 
+    cout << i + 1 << ". " 
+         << exposures[i].first // Address
+         << " (" << exposures[i].second << ")" // Exposure
          << endl;
 }
 
+/**
+ * @brief Demonstration of k-core decomposition on 
+ * graph of Bitcoin transactions.
+ * 
+ * @param g Graph.
+ * 
+ * Addresses with high coreness are part of a densely connected core, 
+ * like exchanges and mixers transacting with each other.
+ */
+void corenessDemo(const Graph& g, const string& outputDir) {
+  cout << "Coreness Demo \n" << endl;
+
+  string filename = outputDir + "/coreness.txt";
+
+  cout << "Getting addresses by coreness..." << endl;
+
+  vector<pair<string, unsigned int>> coreness = g.getAddressesByCoreness();
+  vector<string> corenessLines;
+
+  for (const auto& core : coreness)
+    corenessLines.push_back(core.first + "," + to_string(core.second));
+
+  writeVectorToFile(corenessLines, filename);
+  cout << "Addresses with their coreness outputted to " << filename << "\n" << endl;
+
+  if (!coreness.empty())
+    cout << "The graph has a maximum coreness of " << coreness.front().second << "\n" << endl;
+}
+
+/**
+ * @brief Demonstration of dense subgraph discovery on 
+ * graph of Bitcoin transactions.
+ * 
+ * @param g            Graph.
+ * @param batchPeeling If true, use parallel batch peeling.
+ * 
+ * Groups of addresses moving large amounts between each other 
+ * point to coordinated rings of addresses.
+ */
+void denseSubgraphsDemo(const Graph& g, const string& outputDir, bool batchPeeling) {
+  cout << "Dense Subgraphs Demo \n" << endl;
+
+  string filename = outputDir + "/denseSubgraphs.txt";
+
+  cout << "Peeling graph for the densest subgraphs..." << endl;
+
+  vector<Graph::DenseSubgraph> subgraphs = g.getDenseSubgraphs(10, true, 0.1, batchPeeling);
+  vector<string> subgraphLines;
+
+  for (const Graph::DenseSubgraph& subgraph : subgraphs) {
+    string line = to_string(subgraph.density);
+    for (const string& address : subgraph.addresses)
+      line += "," + address;
+    subgraphLines.push_back(line);
+  }
+
+  writeVectorToFile(subgraphLines, filename);
+  cout << "Dense subgraphs with their density outputted to " << filename << "\n" << endl;
+
+  cout << "Densest subgraphs with their size and density in BTC per address:\n" << endl;
+  for (size_t i = 0; i < subgraphs.size(); ++i) 
+    cout << i + 1 << ". " 
+         << subgraphs[i].addresses.size() << " addresses" // Size
+         << " (" << subgraphs[i].density << ")" // Density
+         << endl;
+}
+
+/**
+ * @brief Demonstration of community detection on 
+ * graph of Bitcoin transactions.
+ * 
+ * @param g                   Graph.
+ * @param labelPropagation    Use label propagation instead of Louvain.
+ * 
+ * Addresses in the same community transact mostly with each other, 
+ * so they are likely to belong to the same entity.
+ */
+void communitiesDemo(const Graph& g, const string& outputDir, bool labelPropagation) {
+  cout << "Communities Demo \n" << endl;
+
+  string filename = outputDir + (labelPropagation ? "/labelPropagationCommunities.txt" : "/louvainCommunities.txt");
+
+  cout << "Grouping addresses into communities with " 
+       << (labelPropagation ? "label propagation" : "Louvain") << "..." << endl;
+
+  vector<pair<string, size_t>> communities = labelPropagation ? g.getCommunitiesByLabelPropagation() 
+                                                              : g.getCommunitiesByLouvain();
+  vector<string> communityLines;
+
+  for (const auto& community : communities)
+    communityLines.push_back(community.first + "," + to_string(community.second));
+
+  writeVectorToFile(communityLines, filename);
+  cout << "Addresses with their community outputted to " << filename << "\n" << endl;
+
+  if (!communities.empty())
+    cout << "Found " << communities.back().second + 1 << " communities among " 
+         << communities.size() << " addresses\n" << endl;
+}
+
+/**
+ * @brief Demonstration of short cycle counting on 
+ * graph of Bitcoin transactions.
+ * 
+ * @param g Graph.
+ * 
+ * Addresses sending BTC back and forth in cycles of two or three 
+ * addresses are a strong signal of wash trading.
+ */
+void cyclesDemo(const Graph& g, const string& outputDir) {
+  cout << "Cycles Demo \n" << endl;
+
+  string filename = outputDir + "/cycles.txt";
+
+  cout << "Counting cycles and triangles..." << endl;
+
+  vector<pair<string, Graph::CycleCounts>> cycles = g.getAddressesByCycleCount();
+  vector<string> cycleLines;
+  Graph::CycleCounts totals;
+
+  for (const auto& address : cycles) {
+    const Graph::CycleCounts& counts = address.second;
+    cycleLines.push_back(address.first + "," + to_string(counts.twoCycles) + "," 
+                         + to_string(counts.threeCycles) + "," + to_string(counts.triangles));
+
+    totals.twoCycles += counts.twoCycles;
+    totals.threeCycles += counts.threeCycles;
+    totals.triangles += counts.triangles;
+  }
+
+  writeVectorToFile(cycleLines, filename);
+  cout << "Addresses with their two cycle, three cycle and triangle counts outputted to " << filename << "\n" << endl;
+
+  // Every two cycle is counted by both addresses and every three cycle and triangle by all three.
+  cout << "The graph contains " << totals.twoCycles / 2 << " two cycles, " 
+       << totals.threeCycles / 3 << " three cycles and " 
+       << totals.triangles / 3 << " triangles\n" << endl;
+}
+
+/**
+ * @brief Demonstration of peel chain detection on 
+ * graph of Bitcoin transactions.
+ * 
+ * @param g Graph.
+ * 
+ * In a peel chain each address forwards most of its BTC to a fresh 
+ * address and peels off a small amount, a classic laundering pattern.
+ */
+void peelChainsDemo(const Graph& g, const string& outputDir) {
+  cout << "Peel Chains Demo \n" << endl;
+
+  string filename = outputDir + "/peelChains.txt";
+
+  cout << "Following dominant transactions from every address..." << endl;
+
+  vector<Graph::PeelChain> chains = g.getPeelChains();
+  vector<string> chainLines;
+
+  for (const Graph::PeelChain& chain : chains) {
+    string line = to_string(chain.addresses.size() - 1) + "," + to_string(chain.amount) + "," + to_string(chain.peeledAmount);
+    for (const string& address : chain.addresses)
+      line += "," + address;
+    chainLines.push_back(line);
+  }
+
+  writeVectorToFile(chainLines, filename);
+  cout << "Peel chains with their length, amount and peeled amount outputted to " << filename << "\n" << endl;
+
+  cout << "Found " << chains.size() << " peel chains";
+  if (!chains.empty())
+    cout << ", the longest with " << chains[0].addresses.size() - 1 << " transactions starting at " << chains[0].addresses[0];
+  cout << "\n" << endl;
+}
+
+/**
+ * @brief Demonstration of MinHash similarity search on 
+ * graph of Bitcoin transactions.
+ * 
+ * @param g Graph.
+ * 
+ * Addresses sharing most of their counterparties are often 
+ * owned by the same entity.
+ */
+void similarityDemo(Graph& g, const string& outputDir) {
+  cout << "Similarity Demo \n" << endl;
+
+  string filename = outputDir + "/similarAddresses.txt";
+
+  cout << "Building similarity index..." << endl;
+  g.buildSimilarityIndex();
+
+  cout << "Getting pairs of addresses with similar counterparties..." << endl;
+
+  vector<pair<pair<string, string>, double>> similarPairs = g.getSimilarAddressPairs();
+  vector<string> pairLines;
+
+  for (const auto& similarPair : similarPairs)
+    pairLines.push_back(similarPair.first.first + "," + similarPair.first.second + "," + to_string(similarPair.second));
+
+  writeVectorToFile(pairLines, filename);
+  cout << "Similar pairs of addresses outputted to " << filename << "\n" << endl;
+
+  string address;
+
+  cout << "Input an address from /" + outputDir + "/transactions.csv" << endl;
+  cout << "Bitcoin Address: ";
+  getline(cin >> ws, address);
+
+  vector<pair<string, double>> similarAddresses = g.getSimilarAddresses(address);
+
+  cout << "\nTop 10 addresses with their similarity to " << address << ":\n" << endl;
+  for (size_t i = 0; i < similarAddresses.size(); ++i) 
+    cout << i + 1 << ". " 
+         << similarAddresses[i].first // Address
+         << " (" << similarAddresses[i].second << ")" // Similarity
+         << endl;
+}
+
+/**
+ * @brief Demonstration of haircut taint propagation on 
+ * graph of Bitcoin transactions.
+ * 
+ * @param g                 Graph.
+ * @param blacklistFilepath File with one blacklisted address per line.
+ * 
+ * Taint of an address is the fraction of BTC it received that 
+ * traces back to blacklisted addresses, with BTC split over 
+ * outbound transactions in proportion to their amounts.
+ */
+void taintDemo(const Graph& g, const string& outputDir, const string& blacklistFilepath) {
+  cout << "Taint Demo \n" << endl;
+
+  string filename = outputDir + "/taint.txt";
+  vector<string> blacklist = readVectorFromFile(blacklistFilepath);
+
+  cout << "Propagating taint from " << blacklist.size() << " blacklisted addresses..." << endl;
+
+  vector<pair<string, double>> taint = g.getAddressesByTaint(blacklist);
+  vector<string> taintLines;
+
+  for (const auto& address : taint)
+    taintLines.push_back(address.first + "," + to_string(address.second));
+
+  writeVectorToFile(taintLines, filename);
+  cout << "Tainted addresses with their taint outputted to " << filename << "\n" << endl;
+  cout << taint.size() << " addresses received tainted BTC\n" << endl;
+}
+
+/**
+ * @brief Demonstration of multi-source Dijkstra on graph of Bitcoin 
+ * transactions, finding the nearest known entity of every address.
+ * 
+ * @param g              Graph.
+ * @param labelsFilepath File with one labeled address per line, optionally 
+ *                       followed by a comma and the name of its entity.
+ * @param towardLabels   If true, paths lead from each address to an entity.
+ */
+void nearestLabelsDemo(const Graph& g, const string& outputDir, const string& labelsFilepath, bool towardLabels) {
+  cout << "Nearest Labels Demo \n" << endl;
+
+  string filename = outputDir + "/nearestLabels.txt";
+  vector<string> labelLines = readVectorFromFile(labelsFilepath);
+  vector<string> labeledAddresses;
+  unordered_map<string, string> entities;
+
+  for (const string& line : labelLines) {
+    size_t comma = line.find(',');
+    string address = line.substr(0, comma);
+
+    labeledAddresses.push_back(address);
+    entities[address] = comma == string::npos ? address : line.substr(comma + 1);
+  }
+
+  cout << "Searching from " << labeledAddresses.size() << " labeled addresses..." << endl;
+
+  vector<pair<string, Graph::NearestLabel>> nearestLabels = g.getNearestLabeledAddresses(labeledAddresses, towardLabels);
+  vector<string> nearestLines;
+
+  for (const auto& address : nearestLabels) {
+    const Graph::NearestLabel& nearest = address.second;
+    nearestLines.push_back(address.first + "," + nearest.labeledAddress + "," 
+                           + entities[nearest.labeledAddress] + "," + to_string(nearest.cost));
+  }
+
+  writeVectorToFile(nearestLines, filename);
+  cout << "Addresses with their nearest labeled address, entity and path cost outputted to " << filename << "\n" << endl;
+  cout << nearestLabels.size() << " addresses are connected to a labeled address\n" << endl;
+}
+
+/**
+ * @brief Demonstration of random walk corpus generation on 
+ * graph of Bitcoin transactions.
+ * 
+ * @param g             Graph.
+ * @param walksFilepath File to write walks to, written as binary if it ends in ".bin".
+ * @param p             node2vec return parameter.
+ * @param q             node2vec in-out parameter.
+ * 
+ * Walks follow transactions in proportion to their amounts and 
+ * are used to train address embeddings with DeepWalk or node2vec.
+ */
+void randomWalksDemo(const Graph& g, const string& walksFilepath, double p, double q) {
+  cout << "Random Walks Demo \n" << endl;
+
+  bool binary = walksFilepath.size() >= 4 && walksFilepath.compare(walksFilepath.size() - 4, 4, ".bin") == 0;
+
+  cout << "Generating random walks with p = " << p << " and q = " << q << "..." << endl;
+
+  steady_clock::time_point start = steady_clock::now();
+  size_t steps = g.writeRandomWalks(walksFilepath, 10, 80, p, q, binary);
+  duration<double> elapsed = steady_clock::now() - start;
+
+  cout << "Walks outputted to " << walksFilepath << "\n" << endl;
+  cout << "Generated " << steps << " steps (" << steps / max(elapsed.count(), 1e-9) << " steps per second)\n" << endl;
+}
+
+/**
+ * @brief Print heap memory held by each data structure of graph.
+ * 
+ * @param g             Graph.
+ * @param loadHeapUsage Heap memory allocated while loading graph, 
+ *                      if allocations are counted.
+ * 
+ * Compares the estimate against the heap memory actually allocated 
+ * when built with 'make COUNT_ALLOCATIONS=1'.
+ */
+void memoryUsageDemo(const Graph& g, const HeapUsage& loadHeapUsage) {
+  cout << "Memory Usage Demo \n" << endl;
+
+  Graph::MemoryUsage usage = g.memoryUsage();
+
+  for (const Graph::MemoryUsageEntry& entry : usage.entries) {
+    cout << entry.name << ": " << entry.bytes << " bytes in " << entry.allocations << " allocations";
+    if (entry.slackBytes > 0)
+      cout << " (" << entry.slackBytes << " bytes of slack)";
+    cout << endl;
+  }
+
+  cout << "\nTotal: " << usage.bytes << " bytes in " << usage.allocations << " allocations ("
+       << usage.slackBytes << " bytes of slack)" << endl;
+
+  if (heapCountingEnabled()) {
+    double error = loadHeapUsage.bytes > 0 ? ((double) usage.bytes - loadHeapUsage.bytes) / loadHeapUsage.bytes : 0;
+    cout << "Measured: " << loadHeapUsage.bytes << " bytes in " << loadHeapUsage.allocations 
+         << " allocations, estimate is off by " << error * 100 << "%" << endl;
+  }
+
+  cout << endl;
+}
+
+// Server stopped by SIGINT and SIGTERM.
+static QueryServer* runningServer = nullptr;
+
+/**
+ * @brief Stop running server on signal.
+ * 
+ * @param signal Signal received.
+ */
+void stopServer(int) {
+  if (runningServer)
+    runningServer -> stop();
+}
+
+/**
+ * @brief Answer queries on graph over Unix domain socket until interrupted.
+ * 
+ * @param g          Graph.
+ * @param socketPath Path of socket to listen on.
+ * 
+ * Queries are sent with './client' or QueryClient.
+ */
+void serveDemo(const Graph& g, const string& socketPath) {
+  cout << "Query Server Demo \n" << endl;
+
+  QueryServer server(g, socketPath, getThreadCount());
+  runningServer = &server;
+  signal(SIGINT, stopServer);
+  signal(SIGTERM, stopServer);
+
+  cout << "Answering queries on " << socketPath << " with " << getThreadCount() 
+       << " threads, press Ctrl+C to stop..." << endl;
+  server.serve();
+
+  signal(SIGINT, SIG_DFL);
+  signal(SIGTERM, SIG_DFL);
+  runningServer = nullptr;
+
+  cout << "Answered " << server.getRequestCount() << " queries \n" << endl;
+}
+
 int main(int argc, const char * argv[]) {
   string inputFilepath = "data/transactions.csv";
   string outputDir = "data";
+  unsigned int coreK = 0;
+  string blacklistFilepath;
+  string walksFilepath;
+  string labelsFilepath;
+  string generateFilepath;
+  string statsFilepath;
+  string traceFilepath;
+  string socketPath;
+  string pathQueriesFilepath;
+  GeneratorOptions generatorOptions;
+  bool towardLabels = false;
+  double node2vecP = 1;
+  double node2vecQ = 1;
   bool BFSEnabled = false;
   bool mostLikelyPathEnabled = false;
   bool centralityEnabled = false;
+  bool pageRankEnabled = false;
+  bool exposureEnabled = false;
+  bool distanceCentralityEnabled = false;
+  bool corenessEnabled = false;
+  bool louvainEnabled = false;
+  bool labelPropagationEnabled = false;
+  bool cyclesEnabled = false;
+  bool satoshiFlowEnabled = false;
+  bool similarityEnabled = false;
+  bool maxFlowEnabled = false;
+  bool peelChainsEnabled = false;
+  bool denseSubgraphsEnabled = false;
+  bool batchPeeling = false;
+  bool perfCountersEnabled = false;
+  bool memoryUsageEnabled = false;
+  size_t maxFlowHops = 0;
 
   string currentArg;
   for (int i = 1; i < argc; ++i) {
-    if (currentArg == "--input-filepath") {
-      inputFilepath = argv[i];
-    } else if (currentArg == "--output-directory") {
-      outputDir = argv[i];
+    try {
+      if (currentArg == "--input-filepath") {
+        inputFilepath = argv[i];
+      } else if (currentArg == "--output-directory") {
+        outputDir = argv[i];
+      } else if (currentArg == "--core") {
+        coreK = parseUnsigned(argv[i]);
+      } else if (currentArg == "--taint") {
+        blacklistFilepath = argv[i];
+      } else if (currentArg == "--max-flow-hops") {
+        maxFlowHops = parseUnsigned(argv[i]);
+      } else if (currentArg == "--generate") {
+        generateFilepath = argv[i];
+      } else if (currentArg == "--generate-scale") {
+        generatorOptions.scale = parseUnsigned(argv[i], UINT_MAX);
+      } else if (currentArg == "--generate-transactions") {
+        generatorOptions.transactionCount = parseUnsigned(argv[i]);
+      } else if (currentArg == "--generate-seed") {
+        generatorOptions.seed = parseUnsigned(argv[i]);
+      } else if (currentArg == "--trace") {
+        traceFilepath = argv[i];
+      } else if (currentArg == "--path-queries") {
+        pathQueriesFilepath = argv[i];
+      } else if (currentArg == "--serve") {
+        socketPath = argv[i];
+      } else if (currentArg == "--stats") {
+        statsFilepath = argv[i];
+      } else if (currentArg == "--nearest-labels") {
+        labelsFilepath = argv[i];
+      } else if (currentArg == "--random-walks") {
+        walksFilepath = argv[i];
+      } else if (currentArg == "--node2vec-p") {
+        node2vecP = stod(argv[i]);
+        if (!(node2vecP > 0))
+          throw string("Value of --node2vec-p must be positive!");
+      } else if (currentArg == "--node2vec-q") {
+        node2vecQ = stod(argv[i]);
+        if (!(node2vecQ > 0))
+          throw string("Value of --node2vec-q must be positive!");
+      }
+    } catch (const std::logic_error&) {
+      // Numbers are invalid or out of range.
+      cout << "Invalid value \"" << argv[i] << "\" for " << currentArg << "!" << endl;
+      return 1;
+    } catch (string e) {
+      cout << e << endl;
+      return 1;
     }
 
     currentArg = argv[i];
@@ -176,6 +1030,38 @@ int main(int argc, const char * argv[]) {
       mostLikelyPathEnabled = true;
     } else if (currentArg == "--betweenness-centrality") {
       centralityEnabled = true;
+    } else if (currentArg == "--pagerank") {
+      pageRankEnabled = true;
+    } else if (currentArg == "--exposure") {
+      exposureEnabled = true;
+    } else if (currentArg == "--distance-centrality") {
+      distanceCentralityEnabled = true;
+    } else if (currentArg == "--coreness") {
+      corenessEnabled = true;
+    } else if (currentArg == "--louvain") {
+      louvainEnabled = true;
+    } else if (currentArg == "--label-propagation") {
+      labelPropagationEnabled = true;
+    } else if (currentArg == "--cycles") {
+      cyclesEnabled = true;
+    } else if (currentArg == "--satoshi-flow") {
+      satoshiFlowEnabled = true;
+    } else if (currentArg == "--similarity") {
+      similarityEnabled = true;
+    } else if (currentArg == "--max-flow") {
+      maxFlowEnabled = true;
+    } else if (currentArg == "--peel-chains") {
+      peelChainsEnabled = true;
+    } else if (currentArg == "--dense-subgraphs") {
+      denseSubgraphsEnabled = true;
+    } else if (currentArg == "--batch-peeling") {
+      batchPeeling = true;
+    } else if (currentArg == "--toward-labels") {
+      towardLabels = true;
+    } else if (currentArg == "--perf-counters") {
+      perfCountersEnabled = true;
+    } else if (currentArg == "--memory-usage") {
+      memoryUsageEnabled = true;
     }
   }
 
@@ -188,27 +1074,142 @@ int main(int argc, const char * argv[]) {
     return 1;
   }
 
-  // Initialize graph
-  cout << "Loading /" + inputFilepath << endl;
+  // Phases are only profiled when asked, without counters they are still timed.
+  unique_ptr<PerfCounters> perfCounters;
+  if (perfCountersEnabled) {
+    perfCounters.reset(new PerfCounters());
+    if (!perfCounters -> getError().empty())
+      cout << "WARNING: " << perfCounters -> getError() << "\n" << endl;
+  }
+
+  if (!traceFilepath.empty())
+    startTracing();
+
   try {
+    // Write synthetic transactions and load them instead.
+    if (!generateFilepath.empty()) {
+      cout << "Generating synthetic transactions..." << endl;
+
+      steady_clock::time_point start = steady_clock::now();
+      size_t transactionCount = writeSyntheticTransactions(generateFilepath, generatorOptions);
+      duration<double> elapsed = steady_clock::now() - start;
+
+      cout << "Generated " << transactionCount << " Transactions to " << generateFilepath 
+           << " in " << elapsed.count() << " seconds \n" << endl;
+      inputFilepath = generateFilepath;
+    }
+
+    // Initialize graph
+    cout << "Loading /" + inputFilepath << endl;
+    if (perfCounters)
+      perfCounters -> start();
+
+    HeapUsage heapUsageBeforeLoad = getHeapUsage();
     Graph g("./" + inputFilepath);
+    HeapUsage loadHeapUsage = getHeapUsage();
+    loadHeapUsage.bytes -= heapUsageBeforeLoad.bytes;
+    loadHeapUsage.allocations -= heapUsageBeforeLoad.allocations;
+
+    // Transactions are only known once loaded.
+    if (perfCounters)
+      writePerfSample(cout, "load", perfCounters -> stop(), g.getTransactionCount());
 
     cout << "Loaded " << g.getAddressCount() << " Addresses and " 
                       << g.getTransactionCount() << " Transactions \n\n" << endl;
 
+    if (memoryUsageEnabled) {
+      memoryUsageDemo(g, loadHeapUsage);
+    }
+    if (corenessEnabled) {
+      corenessDemo(g, outputDir);
+    }
+
+    // Run remaining methods on the k-core only.
+    if (coreK > 0) {
+      g = g.getCore(coreK);
+
+      cout << "Reduced to " << coreK << "-core with " << g.getAddressCount() << " Addresses and " 
+           << g.getTransactionCount() << " Transactions \n\n" << endl;
+    }
+
     if (BFSEnabled) {
-      BFSDemo(g, outputDir);
+      BFSDemo(g, outputDir, perfCounters.get());
     }
     if (mostLikelyPathEnabled) {
-      mostLikelyPathDemo(g, outputDir);
+      mostLikelyPathDemo(g, outputDir, perfCounters.get());
+    }
+    if (!pathQueriesFilepath.empty()) {
+      pathQueriesDemo(g, outputDir, pathQueriesFilepath);
+    }
+    if (satoshiFlowEnabled) {
+      satoshiFlowDemo(g, outputDir);
+    }
+    if (maxFlowEnabled) {
+      maxFlowDemo(g, outputDir, maxFlowHops);
     }
     if (centralityEnabled) {
-      centralityDemo(g, outputDir);
+      centralityDemo(g, outputDir, perfCounters.get());
+    }
+    if (pageRankEnabled) {
+      pageRankDemo(g, outputDir);
+    }
+    if (exposureEnabled) {
+      exposureDemo(g, outputDir);
+    }
+    if (distanceCentralityEnabled) {
+      distanceCentralityDemo(g, outputDir);
+    }
+    if (denseSubgraphsEnabled) {
+      denseSubgraphsDemo(g, outputDir, batchPeeling);
+    }
+    if (louvainEnabled) {
+      communitiesDemo(g, outputDir, false);
+    }
+    if (labelPropagationEnabled) {
+      communitiesDemo(g, outputDir, true);
+    }
+    if (cyclesEnabled) {
+      cyclesDemo(g, outputDir);
+    }
+    if (peelChainsEnabled) {
+      peelChainsDemo(g, outputDir);
+    }
+    if (similarityEnabled) {
+      similarityDemo(g, outputDir);
+    }
+    if (!blacklistFilepath.empty()) {
+      taintDemo(g, outputDir, blacklistFilepath);
+    }
+    if (!labelsFilepath.empty()) {
+      nearestLabelsDemo(g, outputDir, labelsFilepath, towardLabels);
+    }
+    if (!walksFilepath.empty()) {
+      randomWalksDemo(g, walksFilepath, node2vecP, node2vecQ);
+    }
+    if (!socketPath.empty()) {
+      serveDemo(g, socketPath);
     }
   } catch (string e) {
     cout << e << endl;
     return 1;
   }
 
+  if (!traceFilepath.empty()) {
+    stopTracing();
+
+    ofstream traceFile(traceFilepath);
+    writeTraceJson(traceFile);
+    cout << "Trace outputted to " << traceFilepath << endl;
+  }
+
+  if (!statsFilepath.empty()) {
+    if (!statsEnabled())
+      cout << "Stats are only recorded when built with 'make STATS=1'" << endl;
+
+    ofstream statsFile(statsFilepath);
+    writeStatsJson(statsFile);
+    cout << "Stats outputted to " << statsFilepath << endl;
+  }
+
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+using std::min;
+using std::max;
+using std::sort;
+using std::inplace_merge;
+
+#include <atomic>
+using std::atomic;
+
+#include <thread>
+using std::thread;
+
+#include <vector>
+using std::vector;
+
+#include "trace.h"
+
+/**
+ * @brief Get the number of threads used by parallel loops.
+ *
+ * @return size_t Number of hardware threads, at least 1.
+ */
+inline size_t getThreadCount() {
+    return max<size_t>(1, thread::hardware_concurrency());
+}
+
+/**
+ * @brief Run function over range of indexes split into blocks
+ * which are claimed by worker threads until none are left.
+ *
+ * @param begin     First index in range.
+ * @param end       One past the last index in range.
+ * @param function  Called as function(threadIdx, blockBegin, blockEnd)
+ *                  for every block, threadIdx is less than getThreadCount().
+ * @param blockSize Number of indexes in each block.
+ *
+ * Blocks are claimed dynamically so ranges with uneven
+ * work per index, like node degrees, stay balanced. Every
+ * block is traced, showing any imbalance left.
+ */
+template <typename Function>
+void parallelForBlocks(size_t begin, size_t end, const Function& function, size_t blockSize = 1024) {
+    if (begin >= end)
+        return;
+
+    blockSize = max<size_t>(1, blockSize);
+    size_t blockCount = (end - begin + blockSize - 1) / blockSize;
+    size_t threadCount = min(getThreadCount(), blockCount);
+
+    // Run on calling thread when there is nothing to split.
+    if (threadCount == 1) {
+        for (size_t blockBegin = begin; blockBegin < end; blockBegin += blockSize) {
+            TraceSpan span("parallel block", "parallel", blockBegin);
+            function(0, blockBegin, min(end, blockBegin + blockSize));
+        }
+        return;
+    }
+
+    atomic<size_t> nextBlock(0);
+
+    auto worker = [&] (size_t threadIdx) {
+        for (size_t block = nextBlock++; block < blockCount; block = nextBlock++) {
+            size_t blockBegin = begin + block * blockSize;
+            TraceSpan span("parallel block", "parallel", blockBegin);
+            function(threadIdx, blockBegin, min(end, blockBegin + blockSize));
+        }
+    };
+
+    vector<thread> threads;
+    for (size_t threadIdx = 1; threadIdx < threadCount; ++threadIdx)
+        threads.emplace_back(worker, threadIdx);
+
+    worker(0);
+
+    for (thread& t : threads)
+        t.join();
+}
+
+/**
+ * @brief Run function on every index in range across worker threads.
+ *
+ * @param begin    First index in range.
+ * @param end      One past the last index in range.
+ * @param function Called as function(idx) for every index.
+ */
+template <typename Function>
+void parallelFor(size_t begin, size_t end, const Function& function) {
+    parallelForBlocks(begin, end, [&] (size_t, size_t blockBegin, size_t blockEnd) {
+        for (size_t idx = blockBegin; idx < blockEnd; ++idx)
+            function(idx);
+    });
+}
+
+/**
+ * @brief Sort range across worker threads.
+ * 
+ * @param first      Iterator to first element.
+ * @param last       Iterator past the last element.
+ * @param comparator Strict weak ordering of elements.
+ * 
+ * Equal chunks are sorted in parallel, then neighboring 
+ * chunks are merged in parallel rounds until one is left.
+ */
+template <typename Iterator, typename Comparator>
+void parallelSort(Iterator first, Iterator last, const Comparator& comparator) {
+    size_t size = last - first;
+    size_t chunkCount = min(getThreadCount(), max<size_t>(1, size / 4096));
+
+    if (chunkCount <= 1) {
+        sort(first, last, comparator);
+        return;
+    }
+
+    size_t chunkSize = (size + chunkCount - 1) / chunkCount;
+
+    parallelForBlocks(0, chunkCount, [&] (size_t, size_t chunk, size_t) {
+        sort(first + chunk * chunkSize, first + min(size, (chunk + 1) * chunkSize), comparator);
+    }, 1);
+
+    // Each round merges pairs of sorted runs, doubling their length.
+    for (size_t runSize = chunkSize; runSize < size; runSize *= 2) {
+        size_t pairCount = (size + 2 * runSize - 1) / (2 * runSize);
+
+        parallelForBlocks(0, pairCount, [&] (size_t, size_t pair, size_t) {
+            size_t begin = pair * 2 * runSize;
+            size_t middle = min(size, begin + runSize);
+            size_t end = min(size, begin + 2 * runSize);
+            inplace_merge(first + begin, first + middle, first + end, comparator);
+        }, 1);
+    }
+}
@@ -0,0 +1,210 @@
+#include "perf.h"
+
+#include <chrono>
+using std::chrono::steady_clock;
+using std::chrono::duration;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char* EVENT_NAMES[PERF_EVENT_COUNT] = {
+    "cycles",
+    "instructions",
+    "LLC misses",
+    "branch misses"
+};
+
+/**
+ * @brief Get seconds on a monotonic clock.
+ *
+ * @return double Seconds since an arbitrary point.
+ */
+static double _getSeconds() {
+    duration<double> elapsed = steady_clock::now().time_since_epoch();
+    return elapsed.count();
+}
+
+#ifdef __linux__
+
+/**
+ * @brief Open counter of hardware event for calling process on any CPU.
+ *
+ * @param type   Type of event.
+ * @param config Event of type.
+ * @return int   File descriptor of counter, -1 with errno set if not permitted.
+ */
+static int _openCounter(uint32_t type, uint64_t config) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+
+    // Counting only user space is permitted at the default paranoid level.
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+PerfCounters::PerfCounters() {
+    // Holds type and config of every event.
+    const uint64_t events[PERF_EVENT_COUNT][2] = {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | 
+                              (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+    };
+
+    for (size_t event = 0; event < PERF_EVENT_COUNT; ++event) {
+        fds_[event] = _openCounter((uint32_t) events[event][0], events[event][1]);
+
+        // Some CPUs only have the generic cache miss event, which counts the last level cache.
+        if (fds_[event] < 0 && event == PERF_LLC_MISSES)
+            fds_[event] = _openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+
+        if (fds_[event] < 0 && error_.empty()) {
+            error_ = string(EVENT_NAMES[event]) + " cannot be counted (" + strerror(errno) + ")";
+
+            if (errno == EACCES || errno == EPERM)
+                error_ += ", lowering /proc/sys/kernel/perf_event_paranoid may allow it";
+            else if (errno == ENOENT || errno == EOPNOTSUPP)
+                error_ += ", the CPU or virtual machine may not expose it";
+        }
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : fds_) {
+        if (fd >= 0)
+            close(fd);
+    }
+}
+
+void PerfCounters::start() {
+    for (int fd : fds_) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    startSeconds_ = _getSeconds();
+}
+
+PerfSample PerfCounters::stop() {
+    PerfSample sample;
+    sample.seconds = _getSeconds() - startSeconds_;
+
+    for (size_t event = 0; event < PERF_EVENT_COUNT; ++event) {
+        int fd = fds_[event];
+        if (fd < 0)
+            continue;
+
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+        // Holds value, time enabled and time running.
+        uint64_t values[3];
+        if (read(fd, values, sizeof(values)) != sizeof(values))
+            continue;
+
+        // Event never got a counter while enabled.
+        if (values[2] == 0)
+            continue;
+
+        sample.available[event] = true;
+        sample.values[event] = values[2] < values[1] ? (uint64_t) ((double) values[0] * values[1] / values[2]) : values[0];
+    }
+
+    return sample;
+}
+
+#else
+
+PerfCounters::PerfCounters() {
+    for (int& fd : fds_)
+        fd = -1;
+
+    error_ = "performance counters are only supported on Linux";
+}
+
+PerfCounters::~PerfCounters() { }
+
+void PerfCounters::start() {
+    startSeconds_ = _getSeconds();
+}
+
+PerfSample PerfCounters::stop() {
+    PerfSample sample;
+    sample.seconds = _getSeconds() - startSeconds_;
+    return sample;
+}
+
+#endif
+
+bool PerfCounters::isAvailable() const {
+    for (int fd : fds_) {
+        if (fd >= 0)
+            return true;
+    }
+
+    return false;
+}
+
+const string& PerfCounters::getError() const {
+    return error_;
+}
+
+PerfPhase::PerfPhase(PerfCounters* counters, const string& name, size_t edgeCount)
+    : counters_(counters), name_(name), edgeCount_(edgeCount) {
+    if (counters_)
+        counters_ -> start();
+}
+
+PerfPhase::~PerfPhase() {
+    if (counters_)
+        writePerfSample(cout, name_, counters_ -> stop(), edgeCount_);
+}
+
+void writePerfSample(ostream& out, const string& name, const PerfSample& sample, size_t edgeCount) {
+    out << "Perf counters for " << name << ": " << sample.seconds << " seconds";
+
+    for (size_t event = 0; event < PERF_EVENT_COUNT; ++event) {
+        out << ", " << EVENT_NAMES[event] << " ";
+        if (sample.available[event])
+            out << sample.values[event];
+        else
+            out << "n/a";
+    }
+
+    out << ", IPC ";
+    if (sample.available[PERF_CYCLES] && sample.available[PERF_INSTRUCTIONS] && sample.values[PERF_CYCLES] > 0)
+        out << (double) sample.values[PERF_INSTRUCTIONS] / sample.values[PERF_CYCLES];
+    else
+        out << "n/a";
+
+    for (PerfEvent event : {PERF_LLC_MISSES, PERF_BRANCH_MISSES}) {
+        out << ", " << EVENT_NAMES[event] << " per edge ";
+        if (sample.available[event] && edgeCount > 0)
+            out << (double) sample.values[event] / edgeCount;
+        else
+            out << "n/a";
+    }
+
+    out << endl;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+
+#include <ostream>
+using std::ostream;
+
+#include <string>
+using std::string;
+
+/**
+ * Hardware events read by PerfCounters.
+ */
+enum PerfEvent {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_LLC_MISSES,        // Last level cache read misses.
+    PERF_BRANCH_MISSES,
+    PERF_EVENT_COUNT
+};
+
+/**
+ * Counts of every event between PerfCounters::start() and PerfCounters::stop().
+ */
+struct PerfSample {
+    bool available[PERF_EVENT_COUNT] = {};
+    uint64_t values[PERF_EVENT_COUNT] = {};
+    double seconds = 0;
+};
+
+/**
+ * Hardware performance counters of the calling process through Linux perf_event_open.
+ *
+ * Counters follow threads created after they are opened, so parallel
+ * loops are counted. Events the kernel does not permit, or that the
+ * hardware does not have, are left unavailable rather than failing.
+ */
+class PerfCounters {
+public:
+    /**
+     * @brief Open counters of every event, disabled until started.
+     */
+    PerfCounters();
+
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /**
+     * @brief Check if any event can be counted.
+     *
+     * @return bool True if at least one event was opened.
+     */
+    bool isAvailable() const;
+
+    /**
+     * @brief Get why events could not be opened.
+     *
+     * @return const string& Reason the first unavailable event failed, empty if none did.
+     */
+    const string& getError() const;
+
+    /**
+     * @brief Reset counts of every event to zero and start counting.
+     */
+    void start();
+
+    /**
+     * @brief Stop counting and read counts of every event.
+     *
+     * @return PerfSample Counts since start, scaled up if the kernel
+     *                    multiplexed events because of too few counters.
+     */
+    PerfSample stop();
+
+private:
+    int fds_[PERF_EVENT_COUNT];
+    string error_;
+    double startSeconds_ = 0;
+};
+
+/**
+ * Counts events of one phase of a run, printing them when it ends.
+ */
+class PerfPhase {
+public:
+    /**
+     * @brief Start counting phase.
+     *
+     * @param counters  Counters to count with, nothing is counted if null.
+     * @param name      Name of phase.
+     * @param edgeCount Number of transactions phase works on, for misses per edge.
+     */
+    PerfPhase(PerfCounters* counters, const string& name, size_t edgeCount);
+
+    /**
+     * @brief Stop counting phase and print its IPC and misses per edge.
+     */
+    ~PerfPhase();
+
+    PerfPhase(const PerfPhase&) = delete;
+    PerfPhase& operator=(const PerfPhase&) = delete;
+
+private:
+    PerfCounters* counters_;
+    string name_;
+    size_t edgeCount_;
+};
+
+/**
+ * @brief Write counts of phase with its IPC and misses per edge.
+ *
+ * @param out       Stream to write to.
+ * @param name      Name of phase.
+ * @param sample    Counts of phase.
+ * @param edgeCount Number of transactions phase works on.
+ */
+void writePerfSample(ostream& out, const string& name, const PerfSample& sample, size_t edgeCount);
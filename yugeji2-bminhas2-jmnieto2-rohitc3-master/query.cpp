@@ -0,0 +1,248 @@
+#include "query.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+QueryMessage::QueryMessage(const string& bytes) : bytes_(bytes) { }
+
+void QueryMessage::putUint8(uint8_t value) {
+    bytes_ += (char) value;
+}
+
+void QueryMessage::putUint32(uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8)
+        bytes_ += (char) (value >> shift);
+}
+
+void QueryMessage::putUint64(uint64_t value) {
+    for (int shift = 56; shift >= 0; shift -= 8)
+        bytes_ += (char) (value >> shift);
+}
+
+void QueryMessage::putString(const string& str) {
+    putUint32((uint32_t) str.size());
+    bytes_ += str;
+}
+
+uint8_t QueryMessage::getUint8() {
+    _require(1);
+    return (uint8_t) bytes_[offset_++];
+}
+
+uint32_t QueryMessage::getUint32() {
+    _require(4);
+
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; ++i)
+        value = (value << 8) | (uint8_t) bytes_[offset_++];
+
+    return value;
+}
+
+uint64_t QueryMessage::getUint64() {
+    _require(8);
+
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; ++i)
+        value = (value << 8) | (uint8_t) bytes_[offset_++];
+
+    return value;
+}
+
+string QueryMessage::getString() {
+    size_t size = getUint32();
+    _require(size);
+
+    string str = bytes_.substr(offset_, size);
+    offset_ += size;
+    return str;
+}
+
+const string& QueryMessage::getBytes() const {
+    return bytes_;
+}
+
+void QueryMessage::_require(size_t size) const {
+    if (bytes_.size() - offset_ < size)
+        throw string("Query message is truncated!");
+}
+
+/**
+ * @brief Write every byte to socket, retrying partial writes.
+ *
+ * @param fd   Connected socket.
+ * @param data Bytes to write.
+ * @param size Number of bytes.
+ * @throws string if socket is closed or fails.
+ */
+static void _sendAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        // Closed peers fail the write instead of raising SIGPIPE.
+        ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR)
+                continue;
+            throw string("Query connection failed (") + strerror(errno) + ")!";
+        }
+
+        data += sent;
+        size -= sent;
+    }
+}
+
+/**
+ * @brief Read exactly size bytes from socket.
+ *
+ * @param fd     Connected socket.
+ * @param data   Buffer to read into.
+ * @param size   Number of bytes.
+ * @return size_t Bytes read, less than size only if socket was closed.
+ * @throws string if socket fails.
+ */
+static size_t _receiveAll(int fd, char* data, size_t size) {
+    size_t received = 0;
+    while (received < size) {
+        ssize_t count = recv(fd, data + received, size - received, 0);
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            throw string("Query connection failed (") + strerror(errno) + ")!";
+        }
+
+        if (count == 0)
+            break;
+
+        received += count;
+    }
+
+    return received;
+}
+
+void writeQueryFrame(int fd, const QueryMessage& message) {
+    const string& bytes = message.getBytes();
+    if (bytes.size() > MAX_QUERY_FRAME_SIZE)
+        throw string("Query message is too large!");
+
+    // Length and message are sent together so small frames take one packet.
+    QueryMessage frame;
+    frame.putUint32((uint32_t) bytes.size());
+    string data = frame.getBytes() + bytes;
+
+    _sendAll(fd, data.data(), data.size());
+}
+
+bool readQueryFrame(int fd, QueryMessage& message, uint32_t maxSize) {
+    char header[4];
+    size_t received = _receiveAll(fd, header, sizeof(header));
+    if (received == 0)
+        return false;
+    if (received < sizeof(header))
+        throw string("Query connection closed within a message!");
+
+    uint32_t size = QueryMessage(string(header, sizeof(header))).getUint32();
+    if (size > maxSize)
+        throw string("Query message is too large!");
+
+    string bytes(size, '\0');
+    if (_receiveAll(fd, &bytes[0], size) < size)
+        throw string("Query connection closed within a message!");
+
+    message = QueryMessage(bytes);
+    return true;
+}
+
+QueryClient::QueryClient(const string& socketPath) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if (socketPath.size() >= sizeof(address.sun_path))
+        throw string("Socket path \"" + socketPath + "\" is too long!");
+    strcpy(address.sun_path, socketPath.c_str());
+
+    fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_ < 0)
+        throw string("Socket cannot be created (") + strerror(errno) + ")!";
+
+    if (connect(fd_, (sockaddr*) &address, sizeof(address)) != 0) {
+        string error = string("Server at \"" + socketPath + "\" cannot be reached (") + strerror(errno) + ")!";
+        close(fd_);
+        throw error;
+    }
+}
+
+QueryClient::~QueryClient() {
+    close(fd_);
+}
+
+bool QueryClient::addressExists(const string& address) {
+    QueryMessage request;
+    request.putUint8(QUERY_EXISTS);
+    request.putString(address);
+
+    return _query(request).getUint8() != 0;
+}
+
+long long QueryClient::getAddressBalance(const string& address) {
+    QueryMessage request;
+    request.putUint8(QUERY_BALANCE);
+    request.putString(address);
+
+    return (long long) _query(request).getUint64();
+}
+
+long long QueryClient::getTransactionAmount(const string& senderAddress, const string& recipientAddress) {
+    QueryMessage request;
+    request.putUint8(QUERY_AMOUNT);
+    request.putString(senderAddress);
+    request.putString(recipientAddress);
+
+    return (long long) _query(request).getUint64();
+}
+
+vector<string> QueryClient::mostLikelyPath(const string& senderAddress, const string& recipientAddress) {
+    QueryMessage request;
+    request.putUint8(QUERY_PATH);
+    request.putString(senderAddress);
+    request.putString(recipientAddress);
+
+    QueryMessage response = _query(request);
+    vector<string> path(response.getUint32());
+    for (string& address : path)
+        address = response.getString();
+
+    return path;
+}
+
+vector<pair<string, uint64_t>> QueryClient::getTopCentrality(uint32_t k, uint32_t samplingSize) {
+    QueryMessage request;
+    request.putUint8(QUERY_TOP_CENTRALITY);
+    request.putUint32(k);
+    request.putUint32(samplingSize);
+
+    QueryMessage response = _query(request);
+    vector<pair<string, uint64_t>> ranking(response.getUint32());
+    for (pair<string, uint64_t>& rank : ranking) {
+        rank.first = response.getString();
+        rank.second = response.getUint64();
+    }
+
+    return ranking;
+}
+
+QueryMessage QueryClient::_query(const QueryMessage& request) {
+    writeQueryFrame(fd_, request);
+
+    QueryMessage response;
+    if (!readQueryFrame(fd_, response))
+        throw string("Query server closed the connection!");
+
+    if (response.getUint8() != QUERY_OK)
+        throw response.getString();
+
+    return response;
+}
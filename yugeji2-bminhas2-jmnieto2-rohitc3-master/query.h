@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstdint>
+
+#include <string>
+using std::string;
+
+#include <utility>
+using std::pair;
+
+#include <vector>
+using std::vector;
+
+/**
+ * Queries answered by the query server.
+ *
+ * Every request and response is a frame of a 4-byte big-endian length
+ * followed by that many bytes. A request starts with its type and a
+ * response with its status, followed by their fields. Numbers are
+ * big-endian and strings are prefixed with their 4-byte length.
+ *
+ *   QUERY_EXISTS          address             -> uint8 exists
+ *   QUERY_BALANCE         address             -> int64 satoshis
+ *   QUERY_AMOUNT          sender, recipient   -> int64 satoshis
+ *   QUERY_PATH            sender, recipient   -> uint32 count, count addresses
+ *   QUERY_TOP_CENTRALITY  uint32 k, uint32 sampling size
+ *                                             -> uint32 count, count (address, uint64 score)
+ *
+ * A response with QUERY_ERROR has an error message instead.
+ */
+enum QueryType : uint8_t {
+    QUERY_EXISTS = 1,
+    QUERY_BALANCE,
+    QUERY_AMOUNT,
+    QUERY_PATH,
+    QUERY_TOP_CENTRALITY
+};
+
+enum QueryStatus : uint8_t {
+    QUERY_OK = 0,
+    QUERY_ERROR
+};
+
+// Largest frame read, so a bad length cannot exhaust memory.
+const uint32_t MAX_QUERY_FRAME_SIZE = 1 << 30;
+
+/**
+ * Fields of a request or response, appended in order and read back in order.
+ */
+class QueryMessage {
+public:
+    QueryMessage() = default;
+
+    /**
+     * @brief Wrap bytes of a received frame to read its fields.
+     *
+     * @param bytes Frame without its length.
+     */
+    explicit QueryMessage(const string& bytes);
+
+    /**
+     * @brief Append field to message.
+     */
+    void putUint8(uint8_t value);
+    void putUint32(uint32_t value);
+    void putUint64(uint64_t value);
+    void putString(const string& str);
+
+    /**
+     * @brief Read next field.
+     *
+     * @throws string if the message ends before the field.
+     */
+    uint8_t getUint8();
+    uint32_t getUint32();
+    uint64_t getUint64();
+    string getString();
+
+    /**
+     * @brief Get bytes of message, to send as a frame.
+     *
+     * @return const string& Fields appended so far.
+     */
+    const string& getBytes() const;
+
+private:
+    string bytes_;
+    size_t offset_ = 0;
+
+    /**
+     * @brief Check that the next field fits in message.
+     *
+     * @param size Bytes of next field.
+     * @throws string if it does not.
+     */
+    void _require(size_t size) const;
+};
+
+/**
+ * @brief Write message as a frame to socket.
+ *
+ * @param fd      Connected socket.
+ * @param message Message to write.
+ * @throws string if socket is closed or fails.
+ */
+void writeQueryFrame(int fd, const QueryMessage& message);
+
+/**
+ * @brief Read a frame from socket.
+ *
+ * @param fd      Connected socket.
+ * @param message Set to message read.
+ * @param maxSize Largest frame accepted.
+ * @return bool   False if socket was closed before a frame began.
+ * @throws string if socket is closed within a frame, fails or
+ *                the frame is larger than maxSize.
+ */
+bool readQueryFrame(int fd, QueryMessage& message, uint32_t maxSize = MAX_QUERY_FRAME_SIZE);
+
+/**
+ * Connection to a query server, sending one request at a time.
+ */
+class QueryClient {
+public:
+    /**
+     * @brief Connect to server listening on Unix domain socket.
+     *
+     * @param socketPath Path of socket.
+     * @throws string if server cannot be reached.
+     */
+    explicit QueryClient(const string& socketPath);
+
+    ~QueryClient();
+
+    QueryClient(const QueryClient&) = delete;
+    QueryClient& operator=(const QueryClient&) = delete;
+
+    /**
+     * Same as the Graph methods of the same name, answered by the server.
+     *
+     * @throws string if the connection fails or the server returns an error.
+     */
+    bool addressExists(const string& address);
+    long long getAddressBalance(const string& address);
+    long long getTransactionAmount(const string& senderAddress, const string& recipientAddress);
+    vector<string> mostLikelyPath(const string& senderAddress, const string& recipientAddress);
+
+    /**
+     * @brief Get addresses of highest betweenness centrality.
+     *
+     * @param k            Number of addresses, 0 for every address.
+     * @param samplingSize Number of sampled sources, 0 for every address.
+     * @return vector<pair<string, uint64_t>> Addresses with their score, highest first.
+     * @throws string if the connection fails or the server returns an error.
+     */
+    vector<pair<string, uint64_t>> getTopCentrality(uint32_t k, uint32_t samplingSize = 0);
+
+private:
+    int fd_;
+
+    /**
+     * @brief Send request and wait for its response.
+     *
+     * @param request       Request to send.
+     * @return QueryMessage Response, positioned after its status.
+     * @throws string if the connection fails or the server returns an error.
+     */
+    QueryMessage _query(const QueryMessage& request);
+};
@@ -0,0 +1,325 @@
+#include "server.h"
+#include "trace.h"
+
+#include <cerrno>
+#include <cstring>
+#include <exception>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using std::to_string;
+using std::unique_lock;
+using std::lock_guard;
+using std::promise;
+using std::current_exception;
+
+// Connections waiting to be accepted before new ones are refused.
+static const int LISTEN_BACKLOG = 128;
+
+// Largest request read, requests only hold a few addresses.
+static const uint32_t MAX_REQUEST_SIZE = 1 << 16;
+
+// Sampling sizes whose centrality ranking is kept.
+static const size_t MAX_CENTRALITY_RANKINGS = 4;
+
+// Bytes written to wake serve(), to stop or to watch answered connections again.
+static const char WAKE_STOP = 's';
+static const char WAKE_ANSWERED = 'a';
+
+QueryServer::QueryServer(const Graph& graph, const string& socketPath, size_t threadCount, unsigned int timeout)
+    : graph_(graph), socketPath_(socketPath), threadCount_(threadCount > 0 ? threadCount : 1), 
+      timeout_(timeout), requestCount_(0) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if (socketPath.size() >= sizeof(address.sun_path))
+        throw string("Socket path \"" + socketPath + "\" is too long!");
+    strcpy(address.sun_path, socketPath.c_str());
+
+    // Socket left by a server that did not exit cleanly, other files are kept.
+    struct stat status;
+    if (lstat(socketPath.c_str(), &status) == 0 && S_ISSOCK(status.st_mode))
+        unlink(socketPath.c_str());
+
+    listenFd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd_ < 0)
+        throw string("Socket cannot be created (") + strerror(errno) + ")!";
+
+    if (bind(listenFd_, (sockaddr*) &address, sizeof(address)) != 0 || listen(listenFd_, LISTEN_BACKLOG) != 0) {
+        string error = string("Socket \"" + socketPath + "\" cannot be listened on (") + strerror(errno) + ")!";
+        close(listenFd_);
+        throw error;
+    }
+
+    if (pipe(wakeFds_) != 0) {
+        string error = string("Pipe cannot be created (") + strerror(errno) + ")!";
+        close(listenFd_);
+        unlink(socketPath.c_str());
+        throw error;
+    }
+
+    // Wake-ups never block, and are drained without blocking.
+    fcntl(wakeFds_[0], F_SETFL, O_NONBLOCK);
+    fcntl(wakeFds_[1], F_SETFL, O_NONBLOCK);
+}
+
+QueryServer::~QueryServer() {
+    close(listenFd_);
+    close(wakeFds_[0]);
+    close(wakeFds_[1]);
+    unlink(socketPath_.c_str());
+}
+
+void QueryServer::serve() {
+    {
+        lock_guard<mutex> guard(lock_);
+        stopping_ = false;
+    }
+
+    vector<thread> threads;
+    for (size_t i = 0; i < threadCount_; ++i)
+        threads.emplace_back(&QueryServer::_answerRequests, this);
+
+    // Connections waiting for their next request.
+    vector<int> idle;
+    vector<pollfd> fds;
+    bool stopped = false;
+
+    while (!stopped) {
+        fds.assign({ { listenFd_, POLLIN, 0 }, { wakeFds_[0], POLLIN, 0 } });
+        for (int fd : idle)
+            fds.push_back({ fd, POLLIN, 0 });
+
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        // Hand connections with a request, or closed ones, to the pool.
+        vector<int> stillIdle;
+        {
+            lock_guard<mutex> guard(lock_);
+            for (size_t i = 2; i < fds.size(); ++i) {
+                if (fds[i].revents)
+                    pending_.push_back(fds[i].fd);
+                else
+                    stillIdle.push_back(fds[i].fd);
+            }
+        }
+        changed_.notify_all();
+        idle.swap(stillIdle);
+
+        if (fds[1].revents) {
+            char wake;
+            while (read(wakeFds_[0], &wake, 1) == 1)
+                stopped |= wake == WAKE_STOP;
+
+            lock_guard<mutex> guard(lock_);
+            idle.insert(idle.end(), answered_.begin(), answered_.end());
+            answered_.clear();
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(listenFd_, nullptr, nullptr);
+            if (fd >= 0) {
+                // Reads and writes of a stalled client fail instead of blocking a pool thread.
+                timeval timeout = { (time_t) timeout_, 0 };
+                setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+                setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+                idle.push_back(fd);
+            }
+        }
+    }
+
+    // Requests being answered are finished, others are dropped.
+    {
+        lock_guard<mutex> guard(lock_);
+        stopping_ = true;
+
+        for (int fd : pending_)
+            close(fd);
+        pending_.clear();
+    }
+    changed_.notify_all();
+
+    for (thread& t : threads)
+        t.join();
+
+    for (int fd : idle)
+        close(fd);
+    for (int fd : answered_)
+        close(fd);
+    answered_.clear();
+
+    char wake;
+    while (read(wakeFds_[0], &wake, 1) == 1) { }
+}
+
+void QueryServer::stop() {
+    char wake = WAKE_STOP;
+    ssize_t written = write(wakeFds_[1], &wake, 1);
+    (void) written;
+}
+
+size_t QueryServer::getRequestCount() const {
+    return requestCount_.load();
+}
+
+void QueryServer::_answerRequests() {
+    while (true) {
+        int fd;
+        {
+            unique_lock<mutex> guard(lock_);
+            changed_.wait(guard, [&] () { return !pending_.empty() || stopping_; });
+            if (stopping_)
+                return;
+
+            fd = pending_.front();
+            pending_.pop_front();
+        }
+
+        bool open = _answerRequest(fd);
+
+        {
+            lock_guard<mutex> guard(lock_);
+            if (open && !stopping_) {
+                // Watched again by serve() for its next request.
+                answered_.push_back(fd);
+
+                char wake = WAKE_ANSWERED;
+                ssize_t written = write(wakeFds_[1], &wake, 1);
+                (void) written;
+                continue;
+            }
+        }
+
+        close(fd);
+    }
+}
+
+bool QueryServer::_answerRequest(int fd) {
+    try {
+        QueryMessage request;
+        if (!readQueryFrame(fd, request, MAX_REQUEST_SIZE))
+            return false;
+
+        QueryMessage response;
+        {
+            TraceSpan span("query", "server");
+            response = _answer(request);
+        }
+
+        writeQueryFrame(fd, response);
+        ++requestCount_;
+        return true;
+    } catch (const string&) {
+        // Connection failed or sent a bad frame, which only closes that connection.
+        return false;
+    }
+}
+
+QueryMessage QueryServer::_answer(QueryMessage& request) {
+    QueryMessage response;
+
+    try {
+        uint8_t type = request.getUint8();
+
+        if (type == QUERY_EXISTS) {
+            string address = request.getString();
+            response.putUint8(QUERY_OK);
+            response.putUint8(graph_.addressExists(address));
+        } else if (type == QUERY_BALANCE) {
+            string address = request.getString();
+            response.putUint8(QUERY_OK);
+            response.putUint64((uint64_t) graph_.getAddressBalance(address));
+        } else if (type == QUERY_AMOUNT) {
+            string senderAddress = request.getString();
+            string recipientAddress = request.getString();
+            response.putUint8(QUERY_OK);
+            response.putUint64((uint64_t) graph_.getTransactionAmount(senderAddress, recipientAddress));
+        } else if (type == QUERY_PATH) {
+            string senderAddress = request.getString();
+            string recipientAddress = request.getString();
+            vector<string> path = graph_.mostLikelyPath(senderAddress, recipientAddress);
+
+            response.putUint8(QUERY_OK);
+            response.putUint32((uint32_t) path.size());
+            for (const string& address : path)
+                response.putString(address);
+        } else if (type == QUERY_TOP_CENTRALITY) {
+            size_t k = request.getUint32();
+            size_t samplingSize = request.getUint32();
+            shared_future<Graph::Ranking> computed = _getCentralityRanking(samplingSize);
+            const Graph::Ranking& ranking = computed.get();
+
+            size_t count = k == 0 || k > ranking.size() ? ranking.size() : k;
+            response.putUint8(QUERY_OK);
+            response.putUint32((uint32_t) count);
+            for (size_t rank = 0; rank < count; ++rank) {
+                response.putString(ranking.getAddress(rank));
+                response.putUint64((uint64_t) ranking.getScore(rank));
+            }
+        } else {
+            throw string("Unknown query type " + to_string(type) + "!");
+        }
+    } catch (const string& e) {
+        response = QueryMessage();
+        response.putUint8(QUERY_ERROR);
+        response.putString(e);
+    } catch (const std::exception& e) {
+        // Failed computations, such as running out of memory, only fail their request.
+        response = QueryMessage();
+        response.putUint8(QUERY_ERROR);
+        response.putString(e.what());
+    }
+
+    return response;
+}
+
+shared_future<Graph::Ranking> QueryServer::_getCentralityRanking(size_t samplingSize) {
+    // Sampling every address or more gives the same ranking.
+    size_t addressCount = graph_.getAddressCount();
+    if (samplingSize == 0 || samplingSize > addressCount)
+        samplingSize = addressCount;
+
+    promise<Graph::Ranking> computed;
+    shared_future<Graph::Ranking> ranking;
+    {
+        lock_guard<mutex> guard(centralityLock_);
+
+        // Computed once, top k of later requests are a prefix of it.
+        CachedRanking& cached = centralityRankings_[samplingSize];
+        cached.lastRequest = ++centralityRequestCount_;
+        if (cached.ranking.valid())
+            return cached.ranking;
+
+        ranking = cached.ranking = computed.get_future().share();
+
+        // Least recently requested ranking is dropped, requests still holding it keep it.
+        if (centralityRankings_.size() > MAX_CENTRALITY_RANKINGS) {
+            auto oldest = centralityRankings_.begin();
+            for (auto it = centralityRankings_.begin(); it != centralityRankings_.end(); ++it)
+                if (it -> second.lastRequest < oldest -> second.lastRequest)
+                    oldest = it;
+
+            centralityRankings_.erase(oldest);
+        }
+    }
+
+    try {
+        computed.set_value(graph_.getCentralityRanking(samplingSize));
+    } catch (...) {
+        // Requests waiting for it fail too instead of waiting forever.
+        computed.set_exception(current_exception());
+    }
+
+    return ranking;
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+using std::atomic;
+
+#include <condition_variable>
+using std::condition_variable;
+
+#include <deque>
+using std::deque;
+
+#include <future>
+using std::shared_future;
+
+#include <map>
+using std::map;
+
+#include <mutex>
+using std::mutex;
+
+#include <string>
+using std::string;
+
+#include <thread>
+using std::thread;
+
+#include <vector>
+using std::vector;
+
+#include "graph.h"
+#include "query.h"
+
+/**
+ * Answers queries on a loaded graph over a Unix domain socket,
+ * so the graph is loaded once for any number of queries.
+ *
+ * Requests are answered by a pool of threads sharing the graph
+ * read-only. Idle connections are watched by the thread calling
+ * serve(), which hands each request to the pool, so many open
+ * connections share few threads. Requests follow the protocol
+ * described in query.h.
+ */
+class QueryServer {
+public:
+    /**
+     * @brief Listen on Unix domain socket, replacing a stale socket at path.
+     *
+     * @param graph       Graph to answer queries on, must outlive server.
+     * @param socketPath  Path of socket.
+     * @param threadCount Number of requests answered at once.
+     * @param timeout     Seconds a connection may stall within a request or
+     *                    response before it is closed, so it cannot hold a thread,
+     *                    0 to wait forever.
+     * @throws string if socket cannot be listened on.
+     */
+    QueryServer(const Graph& graph, const string& socketPath, size_t threadCount, unsigned int timeout = 5);
+
+    /**
+     * @brief Stop serving and remove socket.
+     */
+    ~QueryServer();
+
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+
+    /**
+     * @brief Accept and serve connections until stop() is called.
+     */
+    void serve();
+
+    /**
+     * @brief Make serve() close every connection and return.
+     *
+     * Only writes to a pipe, so it may be called from any thread or a signal handler.
+     */
+    void stop();
+
+    /**
+     * @brief Get number of requests answered so far.
+     *
+     * @return size_t Requests answered, including errors.
+     */
+    size_t getRequestCount() const;
+
+private:
+    const Graph& graph_;
+    string socketPath_;
+    size_t threadCount_;
+    unsigned int timeout_;
+    int listenFd_;
+    int wakeFds_[2];
+    atomic<size_t> requestCount_;
+
+    // Connections with a request waiting for a thread, and those answered 
+    // and waiting to be watched again.
+    mutex lock_;
+    condition_variable changed_;
+    deque<int> pending_;
+    vector<int> answered_;
+    bool stopping_ = false;
+
+    // Full centrality ranking being computed or computed for a number of 
+    // sampled sources, and when it was last requested.
+    struct CachedRanking {
+        shared_future<Graph::Ranking> ranking;
+        size_t lastRequest = 0;
+    };
+
+    // Rankings of the sampling sizes requested most recently.
+    mutex centralityLock_;
+    map<size_t, CachedRanking> centralityRankings_;
+    size_t centralityRequestCount_ = 0;
+
+    /**
+     * @brief Answer requests handed over by serve() until stopping.
+     */
+    void _answerRequests();
+
+    /**
+     * @brief Read request from connection and write its response.
+     *
+     * @param fd    Connected socket with a request waiting.
+     * @return bool False if connection was closed or failed.
+     */
+    bool _answerRequest(int fd);
+
+    /**
+     * @brief Answer request.
+     *
+     * @param request       Request read from a connection.
+     * @return QueryMessage Response, with an error if request is malformed or fails.
+     */
+    QueryMessage _answer(QueryMessage& request);
+
+    /**
+     * @brief Get full centrality ranking, computing it on first request.
+     *
+     * Rankings are computed without holding the lock, and concurrent requests 
+     * for the same sampling size wait for the one computing it.
+     *
+     * @param samplingSize                  Number of sampled sources, 0 for every address.
+     * @return shared_future<Graph::Ranking> Ranking, kept while the future is held.
+     */
+    shared_future<Graph::Ranking> _getCentralityRanking(size_t samplingSize);
+};
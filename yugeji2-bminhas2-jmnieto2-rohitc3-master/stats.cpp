@@ -0,0 +1,133 @@
+#include "stats.h"
+
+#include <algorithm>
+using std::find;
+
+#include <mutex>
+using std::mutex;
+using std::lock_guard;
+
+#include <vector>
+using std::vector;
+
+static const char* COUNTER_NAMES[STAT_COUNTER_COUNT] = {
+    "add_node_hits",
+    "add_node_misses",
+    "duplicate_edges",
+    "dijkstra_pushes",
+    "dijkstra_pops",
+    "dijkstra_relaxations",
+    "centrality_sources"
+};
+
+static const char* TIMER_NAMES[STAT_TIMER_COUNT] = {
+    "load",
+    "load_parse",
+    "add_node",
+    "add_edge",
+    "dijkstra",
+    "path_reconstruction",
+    "centrality"
+};
+
+/**
+ * Stats of live threads and totals of exited threads.
+ */
+struct StatsRegistry {
+    mutex lock;
+    vector<ThreadStats*> threads;
+    Stats exited;
+};
+
+/**
+ * @brief Get registry shared by all threads.
+ *
+ * @return StatsRegistry& Registry, constructed on first use and never
+ *                        destroyed so threads exiting after main still find it.
+ */
+static StatsRegistry& _getRegistry() {
+    static StatsRegistry* registry = new StatsRegistry();
+    return *registry;
+}
+
+/**
+ * @brief Add every counter and timer of source to target.
+ *
+ * @param target Stats to add to.
+ * @param source Stats to add.
+ */
+static void _addStats(Stats& target, const Stats& source) {
+    for (size_t i = 0; i < STAT_COUNTER_COUNT; ++i)
+        target.counters[i] += source.counters[i];
+
+    for (size_t i = 0; i < STAT_TIMER_COUNT; ++i) {
+        target.timerCalls[i] += source.timerCalls[i];
+        target.timerNanoseconds[i] += source.timerNanoseconds[i];
+    }
+}
+
+ThreadStats::ThreadStats() {
+    StatsRegistry& registry = _getRegistry();
+    lock_guard<mutex> guard(registry.lock);
+    registry.threads.push_back(this);
+}
+
+ThreadStats::~ThreadStats() {
+    StatsRegistry& registry = _getRegistry();
+    lock_guard<mutex> guard(registry.lock);
+    _addStats(registry.exited, stats);
+    registry.threads.erase(find(registry.threads.begin(), registry.threads.end(), this));
+}
+
+bool statsEnabled() {
+#ifdef GRAPH_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+Stats getStats() {
+    StatsRegistry& registry = _getRegistry();
+    lock_guard<mutex> guard(registry.lock);
+
+    Stats totals = registry.exited;
+    for (const ThreadStats* threadStats : registry.threads)
+        _addStats(totals, threadStats -> stats);
+
+    return totals;
+}
+
+void resetStats() {
+    StatsRegistry& registry = _getRegistry();
+    lock_guard<mutex> guard(registry.lock);
+
+    registry.exited = Stats();
+    for (ThreadStats* threadStats : registry.threads)
+        threadStats -> stats = Stats();
+}
+
+void writeStatsJson(ostream& out) {
+    Stats stats = getStats();
+
+    out << "{\n"
+        << "  \"enabled\": " << (statsEnabled() ? "true" : "false") << ",\n"
+        << "  \"counters\": {\n";
+
+    for (size_t i = 0; i < STAT_COUNTER_COUNT; ++i) {
+        out << "    \"" << COUNTER_NAMES[i] << "\": " << stats.counters[i] 
+            << (i + 1 < STAT_COUNTER_COUNT ? "," : "") << "\n";
+    }
+
+    out << "  },\n"
+        << "  \"timers\": {\n";
+
+    for (size_t i = 0; i < STAT_TIMER_COUNT; ++i) {
+        out << "    \"" << TIMER_NAMES[i] << "\": { \"calls\": " << stats.timerCalls[i] 
+            << ", \"ms\": " << stats.timerNanoseconds[i] / 1e6 << " }"
+            << (i + 1 < STAT_TIMER_COUNT ? "," : "") << "\n";
+    }
+
+    out << "  }\n"
+        << "}" << std::endl;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+
+#include <chrono>
+
+#include <ostream>
+using std::ostream;
+
+/**
+ * Counters of events in hot paths of Graph.
+ */
+enum StatCounter {
+    STAT_ADD_NODE_HITS,          // Addresses already in graph.
+    STAT_ADD_NODE_MISSES,        // Addresses added to graph.
+    STAT_DUPLICATE_EDGES,        // Transactions ignored for repeating an edge.
+    STAT_DIJKSTRA_PUSHES,
+    STAT_DIJKSTRA_POPS,
+    STAT_DIJKSTRA_RELAXATIONS,   // Edges which shortened the distance to a node.
+    STAT_CENTRALITY_SOURCES,     // Sources searched from by betweenness centrality.
+    STAT_COUNTER_COUNT
+};
+
+/**
+ * Timers of phases of Graph.
+ */
+enum StatTimer {
+    STAT_LOAD,                   // Whole graph constructor.
+    STAT_LOAD_PARSE,             // Splitting lines and parsing amounts.
+    STAT_ADD_NODE,               // Hashing addresses into node dictionary.
+    STAT_ADD_EDGE,               // Checking for and inserting edges.
+    STAT_DIJKSTRA,
+    STAT_PATH_RECONSTRUCTION,    // Following predecessors of most likely paths.
+    STAT_CENTRALITY,
+    STAT_TIMER_COUNT
+};
+
+/**
+ * Totals of every counter and timer.
+ */
+struct Stats {
+    uint64_t counters[STAT_COUNTER_COUNT] = {};
+    uint64_t timerCalls[STAT_TIMER_COUNT] = {};
+    uint64_t timerNanoseconds[STAT_TIMER_COUNT] = {};
+};
+
+/**
+ * Stats recorded by one thread, so recording never contends.
+ * Registers itself to be summed while its thread lives and
+ * adds its totals to those of exited threads when it exits.
+ */
+struct ThreadStats {
+    Stats stats;
+
+    ThreadStats();
+    ~ThreadStats();
+};
+
+/**
+ * @brief Get stats of calling thread.
+ *
+ * @return ThreadStats& Stats only written by calling thread.
+ */
+inline ThreadStats& getThreadStats() {
+    thread_local ThreadStats threadStats;
+    return threadStats;
+}
+
+/**
+ * Adds time from its construction to its destruction to timer.
+ */
+class ScopedStatTimer {
+public:
+    explicit ScopedStatTimer(StatTimer timer) : timer_(timer), start_(std::chrono::steady_clock::now()) { }
+
+    ~ScopedStatTimer() {
+        Stats& stats = getThreadStats().stats;
+        ++stats.timerCalls[timer_];
+        stats.timerNanoseconds[timer_] += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count();
+    }
+
+private:
+    StatTimer timer_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief Check if stats are recorded, that is if compiled with GRAPH_STATS.
+ *
+ * @return bool True if stats are recorded.
+ */
+bool statsEnabled();
+
+/**
+ * @brief Get totals of stats recorded by all threads so far.
+ *
+ * @return Stats Totals of every counter and timer.
+ *
+ * Totals are exact when no parallel loop is running.
+ */
+Stats getStats();
+
+/**
+ * @brief Reset stats of all threads to zero,
+ * while no parallel loop is running.
+ */
+void resetStats();
+
+/**
+ * @brief Write totals of stats as JSON, with timers in milliseconds.
+ *
+ * @param out Stream to write to.
+ */
+void writeStatsJson(ostream& out);
+
+// Recording compiles to nothing unless built with GRAPH_STATS.
+#ifdef GRAPH_STATS
+#define GRAPH_STATS_CONCAT_(lhs, rhs) lhs##rhs
+#define GRAPH_STATS_TIMER_NAME_(line) GRAPH_STATS_CONCAT_(_statTimer, line)
+#define GRAPH_STATS_ADD(counter, value) (getThreadStats().stats.counters[counter] += (value))
+#define GRAPH_STATS_TIMER(timer) ScopedStatTimer GRAPH_STATS_TIMER_NAME_(__LINE__)(timer)
+#else
+#define GRAPH_STATS_ADD(counter, value) ((void) 0)
+#define GRAPH_STATS_TIMER(timer) ((void) 0)
+#endif
+
+#define GRAPH_STATS_INCREMENT(counter) GRAPH_STATS_ADD(counter, 1)
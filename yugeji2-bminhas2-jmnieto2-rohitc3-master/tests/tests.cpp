@@ -10,11 +10,41 @@ using std::ostream;
 
 #include <string>
 using std::string;
+using std::to_string;
 
 #include <utility>
 using std::pair;
 
+#include <sstream>
+using std::stringstream;
+
+#include <cstdio>
+using std::remove;
+
+#include <cstdint>
+
+#include <thread>
+using std::thread;
+
+#include <chrono>
+using std::chrono::milliseconds;
+
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
 #include "../graph.h"
+#include "../generator.h"
+#include "../stats.h"
+#include "../perf.h"
+#include "../trace.h"
+#include "../heap.h"
+#include "../writer.h"
+#include "../parallel.h"
+#include "../query.h"
+#include "../server.h"
 #include "../catch/catch.hpp"
 
 TEST_CASE("test_test_case", "[classic]") {
@@ -261,6 +291,80 @@ TEST_CASE("test_medium_mostLikelyPath", "[classic]") {
   REQUIRE(testPath == solution); 
 }
 
+/******************** Test Graph::isReachable() *************************/
+
+TEST_CASE("test_tiny2_isReachable", "[classic]") {
+  Graph g("./tests/tinySample2.csv");
+
+  REQUIRE(g.isReachable("3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb", "3JCBEDhEE1vZyEuB5gz8hM8gtPyAfKPctX") == true);
+  REQUIRE(g.isReachable("3JCBEDhEE1vZyEuB5gz8hM8gtPyAfKPctX", "3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb") == false);
+  REQUIRE(g.isReachable("3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb", "3NqD4hJmhK2ZL7NrQ7J3MFcjxn51kxbkiB") == false);
+
+  g.buildReachabilityIndex();
+
+  REQUIRE(g.isReachable("3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb", "3JCBEDhEE1vZyEuB5gz8hM8gtPyAfKPctX") == true);
+  REQUIRE(g.isReachable("3Hg7czYUWtMbaXe9CgcyLW2fdwqvBy4END", "3NqD4hJmhK2ZL7NrQ7J3MFcjxn51kxbkiB") == true);
+  REQUIRE(g.isReachable("3JCBEDhEE1vZyEuB5gz8hM8gtPyAfKPctX", "3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb") == false);
+  REQUIRE(g.isReachable("3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb", "3NqD4hJmhK2ZL7NrQ7J3MFcjxn51kxbkiB") == false);
+  REQUIRE(g.isReachable("3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb", "12UAgcBwBcpjRkdowY4tRVwuX7GPLyaNqT") == false);
+
+  // Adding a transaction discards the index.
+  g.addTransaction("3JCBEDhEE1vZyEuB5gz8hM8gtPyAfKPctX", 1000, "3Hg7czYUWtMbaXe9CgcyLW2fdwqvBy4END");
+  REQUIRE(g.isReachable("3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb", "3NqD4hJmhK2ZL7NrQ7J3MFcjxn51kxbkiB") == true);
+}
+
+TEST_CASE("test_small2_isReachable", "[classic]") {
+  Graph g("./tests/smallSample2.csv");
+  Graph indexed("./tests/smallSample2.csv");
+  indexed.buildReachabilityIndex();
+
+  vector<string> addresses = g.BFS();
+
+  // Index must agree with existence of a most likely path for every pair.
+  for (const string& sender : addresses) {
+    for (const string& recipient : addresses) {
+      if (sender != recipient)
+        REQUIRE(indexed.isReachable(sender, recipient) == !g.mostLikelyPath(sender, recipient).empty());
+    }
+  }
+}
+
+/****************** Test Graph::mostLikelyPaths() ***********************/
+
+TEST_CASE("test_small2_mostLikelyPaths", "[classic]") {
+  Graph g("./tests/smallSample2.csv");
+
+  vector<string> addresses = g.BFS();
+  addresses.push_back("missing");
+
+  // Every pair, so most senders share many queries.
+  vector<pair<string, string>> queries;
+  for (const string& sender : addresses) {
+    for (const string& recipient : addresses)
+      queries.emplace_back(sender, recipient);
+  }
+
+  vector<Graph::PathWithAmounts> paths = g.mostLikelyPaths(queries);
+  REQUIRE(paths.size() == queries.size());
+
+  size_t pathCount = 0;
+  for (size_t queryIdx = 0; queryIdx < queries.size(); ++queryIdx) {
+    const Graph::PathWithAmounts& path = paths[queryIdx];
+    REQUIRE(path.addresses == g.mostLikelyPath(queries[queryIdx].first, queries[queryIdx].second));
+    pathCount += !path.addresses.empty();
+
+    long long totalAmount = 0;
+    REQUIRE(path.amounts.size() == (path.addresses.empty() ? 0 : path.addresses.size() - 1));
+    for (size_t i = 0; i < path.amounts.size(); ++i) {
+      REQUIRE(path.amounts[i] == g.getTransactionAmount(path.addresses[i], path.addresses[i + 1]));
+      totalAmount += path.amounts[i];
+    }
+    REQUIRE(path.totalAmount == totalAmount);
+  }
+
+  REQUIRE(pathCount > 0);
+}
+
 /************** Test Graph::getAddressesByCentrality() ******************/
 
 TEST_CASE("test_tiny_getAddressesByCentrality_sampling", "[classic]") {
@@ -363,4 +467,1200 @@ TEST_CASE("test_small_getAddressesByCentrality", "[classic]") {
     else if (p.first == "3BKn5fzKRx7stkBQyGqehWdjJxYCZhQwga")
       REQUIRE(p.second == 5);
   }
-}
\ No newline at end of file
+}
+
+/**************** Test Graph::getCentralityRanking() ********************/
+
+TEST_CASE("test_small_getCentralityRanking", "[classic]") {
+  Graph g("./tests/smallSample.csv");
+
+  vector<pair<string, unsigned int>> scores = g.getAddressesByCentrality();
+  Graph::Ranking ranking = g.getCentralityRanking();
+
+  REQUIRE(ranking.size() == scores.size());
+  for (size_t rank = 0; rank < ranking.size(); ++rank) {
+    REQUIRE(ranking.getAddress(rank) == scores[rank].first);
+    REQUIRE(ranking.getScore(rank) == scores[rank].second);
+  }
+
+  // Top addresses are the first of the full ranking.
+  Graph::Ranking top = g.getCentralityRanking(0, 5);
+
+  REQUIRE(top.size() == 5);
+  for (size_t rank = 0; rank < top.size(); ++rank) {
+    REQUIRE(top.getAddress(rank) == ranking.getAddress(rank));
+    REQUIRE(top.getScore(rank) == ranking.getScore(rank));
+  }
+
+  REQUIRE(g.getCentralityRanking(0, scores.size() + 1).size() == scores.size());
+}
+
+TEST_CASE("test_parallelSort", "[classic]") {
+  vector<size_t> values;
+  for (size_t i = 0; i < 100000; ++i)
+    values.push_back(i * 2654435761u % 1000);
+
+  vector<size_t> expected = values;
+  sort(expected.begin(), expected.end());
+
+  parallelSort(values.begin(), values.end(), [] (size_t lhs, size_t rhs) { return lhs < rhs; });
+
+  REQUIRE(values == expected);
+}
+
+/*************** Test Graph::getAddressesByPageRank() *******************/
+
+TEST_CASE("test_tiny2_getAddressesByPageRank", "[classic]") {
+  Graph g("./tests/tinySample2.csv");
+
+  vector<pair<string, double>> ranks = g.getAddressesByPageRank();
+
+  REQUIRE(ranks.size() == 14);
+
+  double totalRank = 0;
+  for (const auto& rank : ranks)
+    totalRank += rank.second;
+
+  REQUIRE(totalRank == Approx(1.0));
+
+  // Ends of the two five address chains collect the most rank.
+  vector<string> topAddresses = { ranks[0].first, ranks[1].first };
+  sort(topAddresses.begin(), topAddresses.end());
+
+  vector<string> solution = { "3JCBEDhEE1vZyEuB5gz8hM8gtPyAfKPctX", "3NqD4hJmhK2ZL7NrQ7J3MFcjxn51kxbkiB" };
+  REQUIRE(topAddresses == solution);
+  REQUIRE(ranks[0].second == Approx(ranks[1].second));
+}
+
+TEST_CASE("test_small_getAddressesByPageRank", "[classic]") {
+  Graph g("./tests/smallSample.csv");
+
+  vector<pair<string, double>> ranks = g.getAddressesByPageRank(0.85, 1e-12, 1000);
+
+  REQUIRE(ranks.size() == g.getAddressCount());
+
+  for (size_t i = 1; i < ranks.size(); ++i)
+    REQUIRE(ranks[i - 1].second >= ranks[i].second);
+
+  // Single transaction recipients collect rank from their sender.
+  double senderRank = 0;
+  double recipientRank = 0;
+  for (const auto& rank : ranks) {
+    if (rank.first == "1FckoRapKaVE2kktJ2T3oVoGydjQkGy2z2")
+      senderRank = rank.second;
+    else if (rank.first == "1CUTyyxgbKvtCdoYmceQJCZLXCde5akiX2")
+      recipientRank = rank.second;
+  }
+
+  REQUIRE(recipientRank > senderRank);
+}
+
+/***************** Test Graph::getExposedAddresses() ********************/
+
+TEST_CASE("test_tiny2_getExposedAddresses", "[classic]") {
+  Graph g("./tests/tinySample2.csv");
+
+  vector<pair<string, double>> exposures = g.getExposedAddresses({ "3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb" });
+  vector<string> testExposedAddresses;
+
+  for (const auto& exposure : exposures)
+    testExposedAddresses.push_back(exposure.first);
+
+  // Funds collect at the end of the chain, and otherwise 
+  // exposure falls with distance from the seed.
+  vector<string> solution = {
+    "3JCBEDhEE1vZyEuB5gz8hM8gtPyAfKPctX", "38kqvN2sNxJtq4bSY9sYioyk4R7Zo3E5FP",
+    "33PWEGbE5TokjHm7mAGbb3ZmcLqTWvZ6cr", "3N4t1HzpsJipALh1U2dyssvWu9TsNQk4wx"
+  };
+
+  REQUIRE(testExposedAddresses == solution);
+  REQUIRE(exposures[0].second == Approx(0.85 * 0.85 * 0.85 * 0.85));
+  REQUIRE(exposures[1].second == Approx(0.15 * 0.85));
+}
+
+TEST_CASE("test_small_getExposedAddresses", "[classic]") {
+  Graph g("./tests/smallSample.csv");
+
+  REQUIRE(g.getExposedAddresses({ "12UAgcBwBcpjRkdowY4tRVwuX7GPLyaNqT" }).empty());
+  REQUIRE(g.getExposedAddresses({ "1FckoRapKaVE2kktJ2T3oVoGydjQkGy2z2" }, 0).empty());
+
+  vector<pair<string, double>> exposures = g.getExposedAddresses({ "1FckoRapKaVE2kktJ2T3oVoGydjQkGy2z2" }, 1);
+
+  REQUIRE(exposures.size() == 1);
+  REQUIRE(exposures[0].first == "1CUTyyxgbKvtCdoYmceQJCZLXCde5akiX2");
+  REQUIRE(exposures[0].second == Approx(0.85));
+}
+
+TEST_CASE("test_getExposedAddresses_invalidParameters", "[classic]") {
+  Graph g;
+  g.addTransaction("A", 1, "B");
+  g.addTransaction("B", 1, "A");
+
+  // Rank would be pushed around the cycle forever.
+  REQUIRE_THROWS(g.getExposedAddresses({ "A" }, 10, 0, 0.15));
+  REQUIRE_THROWS(g.getExposedAddresses({ "A" }, 10, -1e-4, 0.15));
+  REQUIRE_THROWS(g.getExposedAddresses({ "A" }, 10, 1e-4, 0));
+  REQUIRE_THROWS(g.getExposedAddresses({ "A" }, 10, 1e-4, 1.5));
+  REQUIRE(g.getExposedAddresses({ "A" }, 10, 1e-4, 1).empty());
+}
+
+/********* Test Graph::getAddressesByHarmonicCentrality() ***************/
+
+TEST_CASE("test_tiny2_getAddressesByHarmonicCentrality", "[classic]") {
+  Graph g("./tests/tinySample2.csv");
+
+  vector<pair<string, double>> scores = g.getAddressesByHarmonicCentrality(10);
+
+  REQUIRE(scores.size() == 14);
+  REQUIRE(scores.back().second == Approx(0).margin(0.01));
+
+  // Heads of the two five address chains reach 4 addresses at distances 1 to 4.
+  for (const auto& score : scores) {
+    if (score.first == "3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb" || score.first == "3Hg7czYUWtMbaXe9CgcyLW2fdwqvBy4END")
+      REQUIRE(score.second == Approx(1.0 + 1.0 / 2 + 1.0 / 3 + 1.0 / 4).epsilon(0.05));
+
+    if (score.first == "1BNAYuUfSiY6FCg5LCiJkTYkQAEaAxjUiu")
+      REQUIRE(score.second == Approx(1.0).epsilon(0.05));
+  }
+}
+
+TEST_CASE("test_tiny2_getAddressesByClosenessCentrality", "[classic]") {
+  Graph g("./tests/tinySample2.csv");
+
+  vector<pair<string, double>> scores = g.getAddressesByClosenessCentrality(10);
+
+  for (const auto& score : scores) {
+    if (score.first == "3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb")
+      REQUIRE(score.second == Approx(1.0 / (1 + 2 + 3 + 4)).epsilon(0.05));
+
+    if (score.first == "3JCBEDhEE1vZyEuB5gz8hM8gtPyAfKPctX")
+      REQUIRE(score.second == 0);
+  }
+}
+
+TEST_CASE("test_small_getAddressesByDistanceCentrality", "[classic]") {
+  Graph g("./tests/smallSample.csv");
+
+  // One run gives the same rankings as a run for each.
+  Graph::DistanceCentralities centralities = g.getAddressesByDistanceCentrality(10);
+
+  REQUIRE(centralities.harmonic == g.getAddressesByHarmonicCentrality(10));
+  REQUIRE(centralities.closeness == g.getAddressesByClosenessCentrality(10));
+}
+
+TEST_CASE("test_tiny2_getNeighborhoodFunction", "[classic]") {
+  Graph g("./tests/tinySample2.csv");
+
+  vector<double> neighborhoodFunction = g.getNeighborhoodFunction(10);
+
+  // Every address reaches itself, then pairs are added up to the length of the chains.
+  REQUIRE(neighborhoodFunction.size() == 5);
+  REQUIRE(neighborhoodFunction[0] == Approx(14).epsilon(0.05));
+  REQUIRE(neighborhoodFunction[1] == Approx(14 + 10).epsilon(0.05));
+  REQUIRE(neighborhoodFunction[4] == Approx(14 + 22).epsilon(0.05));
+
+  vector<double> limitedNeighborhoodFunction = g.getNeighborhoodFunction(10, 2);
+  REQUIRE(limitedNeighborhoodFunction.size() == 3);
+}
+
+/*************** Test Graph::getAddressesByCoreness() *******************/
+
+TEST_CASE("test_tiny2_getAddressesByCoreness", "[classic]") {
+  Graph g("./tests/tinySample2.csv");
+
+  vector<pair<string, unsigned int>> coreness = g.getAddressesByCoreness();
+
+  // Every address is part of a chain, so every address has coreness 1.
+  REQUIRE(coreness.size() == 14);
+  REQUIRE(coreness.front().second == 1);
+  REQUIRE(coreness.back().second == 1);
+}
+
+TEST_CASE("test_small2_getAddressesByCoreness", "[classic]") {
+  Graph g("./tests/smallSample2.csv");
+
+  vector<pair<string, unsigned int>> coreness = g.getAddressesByCoreness();
+
+  REQUIRE(coreness.size() == g.getAddressCount());
+
+  for (size_t i = 1; i < coreness.size(); ++i)
+    REQUIRE(coreness[i - 1].second >= coreness[i].second);
+}
+
+/********************** Test Graph::getCore() ***************************/
+
+TEST_CASE("test_small2_getCore", "[classic]") {
+  Graph g("./tests/smallSample2.csv");
+
+  vector<pair<string, unsigned int>> coreness = g.getAddressesByCoreness();
+  unsigned int maxCoreness = coreness.front().second;
+
+  Graph core = g.getCore(maxCoreness);
+
+  size_t coreAddressCount = 0;
+  for (const auto& address : coreness) {
+    REQUIRE(core.addressExists(address.first) == (address.second >= maxCoreness));
+    coreAddressCount += address.second >= maxCoreness;
+  }
+
+  REQUIRE(core.getAddressCount() == coreAddressCount);
+
+  // Every address of the core has the same coreness inside the core.
+  for (const auto& address : core.getAddressesByCoreness())
+    REQUIRE(address.second == maxCoreness);
+
+  REQUIRE(g.getCore(0).getTransactionCount() == g.getTransactionCount());
+}
+
+/************** Test Graph::getCommunitiesByLouvain() *******************/
+
+TEST_CASE("test_tiny2_getCommunitiesByLouvain", "[classic]") {
+  Graph g("./tests/tinySample2.csv");
+
+  vector<pair<string, size_t>> communities = g.getCommunitiesByLouvain();
+  REQUIRE(communities.size() == 14);
+
+  unordered_map<string, size_t> community(communities.begin(), communities.end());
+
+  // Addresses of unconnected chains never share a community.
+  REQUIRE(community["1BNAYuUfSiY6FCg5LCiJkTYkQAEaAxjUiu"] == community["1L5QgNHtcyBFyndhVhY353HyWaXCag4Jx"]);
+  REQUIRE(community["3DVZ9NRjKixMNY3ipTbwdPvwKeCqcuQnUV"] == community["37owVJyjVYLwsTCLRmJ2zD25F5dQZM9okp"]);
+  REQUIRE(community["1BNAYuUfSiY6FCg5LCiJkTYkQAEaAxjUiu"] != community["3DVZ9NRjKixMNY3ipTbwdPvwKeCqcuQnUV"]);
+  REQUIRE(community["3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb"] != community["3Hg7czYUWtMbaXe9CgcyLW2fdwqvBy4END"]);
+
+  // Communities are numbered from largest to smallest.
+  for (size_t i = 1; i < communities.size(); ++i)
+    REQUIRE(communities[i - 1].second <= communities[i].second);
+  REQUIRE(communities.front().second == 0);
+}
+
+TEST_CASE("test_small2_getCommunitiesByLouvain", "[classic]") {
+  Graph g("./tests/smallSample2.csv");
+
+  vector<pair<string, size_t>> communities = g.getCommunitiesByLouvain();
+  REQUIRE(communities.size() == g.getAddressCount());
+
+  // Louvain merges connected addresses, so there are fewer communities than addresses.
+  REQUIRE(communities.back().second + 1 < communities.size());
+}
+
+/********** Test Graph::getCommunitiesByLabelPropagation() **************/
+
+TEST_CASE("test_tiny2_getCommunitiesByLabelPropagation", "[classic]") {
+  Graph g("./tests/tinySample2.csv");
+
+  vector<pair<string, size_t>> communities = g.getCommunitiesByLabelPropagation();
+  REQUIRE(communities.size() == 14);
+
+  unordered_map<string, size_t> community(communities.begin(), communities.end());
+
+  REQUIRE(community["1BNAYuUfSiY6FCg5LCiJkTYkQAEaAxjUiu"] == community["1L5QgNHtcyBFyndhVhY353HyWaXCag4Jx"]);
+  REQUIRE(community["1BNAYuUfSiY6FCg5LCiJkTYkQAEaAxjUiu"] != community["3DVZ9NRjKixMNY3ipTbwdPvwKeCqcuQnUV"]);
+  REQUIRE(community["3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb"] != community["3Hg7czYUWtMbaXe9CgcyLW2fdwqvBy4END"]);
+}
+
+/******************* Test Graph::getCycleCounts() ***********************/
+
+TEST_CASE("test_tiny2_getCycleCounts", "[classic]") {
+  Graph g("./tests/tinySample2.csv");
+
+  Graph::CycleCounts totals = g.getCycleCounts();
+
+  REQUIRE(totals.twoCycles == 0);
+  REQUIRE(totals.threeCycles == 0);
+  REQUIRE(totals.triangles == 0);
+  REQUIRE(g.getAddressesByCycleCount().empty());
+}
+
+TEST_CASE("test_tiny3_getCycleCounts", "[classic]") {
+  Graph g("./tests/tinySample3.csv");
+
+  Graph::CycleCounts totals = g.getCycleCounts();
+
+  REQUIRE(totals.twoCycles == 1);
+  REQUIRE(totals.threeCycles == 1);
+  REQUIRE(totals.triangles == 2);
+}
+
+/************** Test Graph::getAddressesByCycleCount() ******************/
+
+TEST_CASE("test_tiny3_getAddressesByCycleCount", "[classic]") {
+  Graph g("./tests/tinySample3.csv");
+
+  vector<pair<string, Graph::CycleCounts>> cycles = g.getAddressesByCycleCount();
+
+  REQUIRE(cycles.size() == 4);
+  REQUIRE(cycles.front().first == "1FckoRapKaVE2kktJ2T3oVoGydjQkGy2z2");
+
+  for (const auto& address : cycles) {
+    const Graph::CycleCounts& counts = address.second;
+
+    if (address.first == "1FckoRapKaVE2kktJ2T3oVoGydjQkGy2z2") {
+      REQUIRE(counts.twoCycles == 1);
+      REQUIRE(counts.threeCycles == 1);
+      REQUIRE(counts.triangles == 2);
+    }
+
+    if (address.first == "357oZdnMBzc4KSgeqBrS29BgFUpFmfqpsj") {
+      REQUIRE(counts.twoCycles == 1);
+      REQUIRE(counts.threeCycles == 0);
+      REQUIRE(counts.triangles == 1);
+    }
+
+    if (address.first == "13EV17cfgnK4MsxoQwoVqNr3hSqaGJQob2") {
+      REQUIRE(counts.twoCycles == 0);
+      REQUIRE(counts.threeCycles == 1);
+      REQUIRE(counts.triangles == 1);
+    }
+  }
+}
+
+/***************** Test Graph::getAddressesByTaint() ********************/
+
+TEST_CASE("test_tiny2_getAddressesByTaint", "[classic]") {
+  Graph g("./tests/tinySample2.csv");
+
+  vector<pair<string, double>> taint = g.getAddressesByTaint({ "3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb" });
+
+  // Every address down the chain only received tainted BTC.
+  REQUIRE(taint.size() == 5);
+  for (const auto& address : taint)
+    REQUIRE(address.second == Approx(1.0));
+
+  vector<pair<string, double>> limitedTaint = g.getAddressesByTaint({ "3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb" }, 2);
+  vector<string> limitedTaintAddresses;
+
+  for (const auto& address : limitedTaint)
+    limitedTaintAddresses.push_back(address.first);
+  sort(limitedTaintAddresses.begin(), limitedTaintAddresses.end());
+
+  vector<string> solution = {
+    "33PWEGbE5TokjHm7mAGbb3ZmcLqTWvZ6cr", "38kqvN2sNxJtq4bSY9sYioyk4R7Zo3E5FP", "3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb"
+  };
+
+  REQUIRE(limitedTaintAddresses == solution);
+}
+
+TEST_CASE("test_small_getAddressesByTaint", "[classic]") {
+  Graph g("./tests/smallSample.csv");
+
+  vector<pair<string, double>> taint = g.getAddressesByTaint({ "1FckoRapKaVE2kktJ2T3oVoGydjQkGy2z2" });
+
+  // Recipient received 299985332 of its 464283737 satoshis from the blacklisted address.
+  REQUIRE(taint.size() == 2);
+  REQUIRE(taint[0].first == "1FckoRapKaVE2kktJ2T3oVoGydjQkGy2z2");
+  REQUIRE(taint[1].first == "1CUTyyxgbKvtCdoYmceQJCZLXCde5akiX2");
+  REQUIRE(taint[1].second == Approx(299985332.0 / 464283737));
+
+  REQUIRE(g.getAddressesByTaint({ "12UAgcBwBcpjRkdowY4tRVwuX7GPLyaNqT" }).empty());
+}
+
+/***************** Test Graph::simulateSatoshiFlow() ********************/
+
+TEST_CASE("test_tiny2_simulateSatoshiFlow", "[classic]") {
+  Graph g("./tests/tinySample2.csv");
+
+  Graph::SatoshiFlow flow = g.simulateSatoshiFlow("3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb", "3JCBEDhEE1vZyEuB5gz8hM8gtPyAfKPctX", 1000);
+
+  vector<string> solution = {
+    "3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb", 
+    "38kqvN2sNxJtq4bSY9sYioyk4R7Zo3E5FP",
+    "33PWEGbE5TokjHm7mAGbb3ZmcLqTWvZ6cr",
+    "3N4t1HzpsJipALh1U2dyssvWu9TsNQk4wx",
+    "3JCBEDhEE1vZyEuB5gz8hM8gtPyAfKPctX"
+  };
+
+  REQUIRE(flow.reachProbability == 1);
+  REQUIRE(flow.paths.size() == 1);
+  REQUIRE(flow.paths[0].first == solution);
+  REQUIRE(flow.paths[0].second == 1);
+  REQUIRE(flow.walksPerSecond > 0);
+
+  Graph::SatoshiFlow unreachableFlow = g.simulateSatoshiFlow("3JCBEDhEE1vZyEuB5gz8hM8gtPyAfKPctX", "3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb", 1000);
+
+  REQUIRE(unreachableFlow.reachProbability == 0);
+  REQUIRE(unreachableFlow.paths.empty());
+}
+
+TEST_CASE("test_tiny3_simulateSatoshiFlow", "[classic]") {
+  Graph g("./tests/tinySample3.csv");
+
+  string sender = "1FckoRapKaVE2kktJ2T3oVoGydjQkGy2z2";
+  string recipient = "1CUTyyxgbKvtCdoYmceQJCZLXCde5akiX2";
+
+  Graph::SatoshiFlow flow = g.simulateSatoshiFlow(sender, recipient, 100000, 100, 5, 42);
+
+  // Satoshis circle between sender and 357oZ... until they leave towards recipient, 
+  // leaving directly from sender about 80% of the time.
+  REQUIRE(flow.reachProbability == Approx(1.0).margin(0.001));
+  REQUIRE(flow.paths.size() == 2);
+  REQUIRE(flow.paths[0].first == vector<string>({ sender, recipient }));
+  REQUIRE(flow.paths[0].second == Approx(0.8).margin(0.01));
+  REQUIRE(flow.paths[1].first == vector<string>({ sender, "357oZdnMBzc4KSgeqBrS29BgFUpFmfqpsj", recipient }));
+
+  // Same seed gives the same estimate.
+  Graph::SatoshiFlow repeatedFlow = g.simulateSatoshiFlow(sender, recipient, 100000, 100, 5, 42);
+  REQUIRE(repeatedFlow.reachProbability == flow.reachProbability);
+  REQUIRE(repeatedFlow.paths == flow.paths);
+}
+
+/****************** Test Graph::writeRandomWalks() **********************/
+
+TEST_CASE("test_tiny2_writeRandomWalks", "[classic]") {
+  Graph g("./tests/tinySample2.csv");
+
+  string filepath = "./tests/tinySample2Walks.txt";
+  size_t steps = g.writeRandomWalks(filepath, 2, 10);
+
+  ifstream file(filepath);
+  vector<string> walks;
+  string line;
+  while (getline(file, line))
+    walks.push_back(line);
+  file.close();
+  remove(filepath.c_str());
+
+  // Two walks per address, following the chains until they end.
+  REQUIRE(walks.size() == 28);
+  REQUIRE(walks[2] == "3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb 38kqvN2sNxJtq4bSY9sYioyk4R7Zo3E5FP "
+                      "33PWEGbE5TokjHm7mAGbb3ZmcLqTWvZ6cr 3N4t1HzpsJipALh1U2dyssvWu9TsNQk4wx "
+                      "3JCBEDhEE1vZyEuB5gz8hM8gtPyAfKPctX");
+  REQUIRE(steps == 2 * (2 + 1 + 5 + 4 + 3 + 2 + 1 + 2 + 1 + 5 + 4 + 3 + 2 + 1));
+}
+
+TEST_CASE("test_tiny3_writeRandomWalks_binary", "[classic]") {
+  Graph g("./tests/tinySample3.csv");
+
+  string filepath = "./tests/tinySample3Walks.bin";
+  size_t steps = g.writeRandomWalks(filepath, 3, 20, 0.5, 2, true, 7);
+
+  ifstream file(filepath, std::ios::binary);
+  size_t walkCount = 0;
+  size_t readSteps = 0;
+  uint32_t length;
+  while (file.read((char*) &length, sizeof(length))) {
+    vector<uint32_t> walk(length);
+    file.read((char*) walk.data(), length * sizeof(uint32_t));
+
+    for (uint32_t id : walk)
+      REQUIRE(id < g.getAddressCount());
+
+    ++walkCount;
+    readSteps += length;
+  }
+  file.close();
+
+  ifstream vocabulary(filepath + ".vocab");
+  size_t vocabularySize = 0;
+  string address;
+  while (getline(vocabulary, address)) {
+    REQUIRE(g.addressExists(address));
+    ++vocabularySize;
+  }
+  vocabulary.close();
+
+  remove(filepath.c_str());
+  remove((filepath + ".vocab").c_str());
+
+  REQUIRE(walkCount == 3 * g.getAddressCount());
+  REQUIRE(readSteps == steps);
+  REQUIRE(vocabularySize == g.getAddressCount());
+}
+
+TEST_CASE("test_tiny2_writeRandomWalks_invalidParameters", "[classic]") {
+  Graph g("./tests/tinySample2.csv");
+  string filepath = "./tests/tinySample2Walks.txt";
+
+  // Rejection sampling would never accept a step.
+  REQUIRE_THROWS(g.writeRandomWalks(filepath, 2, 10, 0, 1));
+  REQUIRE_THROWS(g.writeRandomWalks(filepath, 2, 10, 1, 0));
+  REQUIRE_THROWS(g.writeRandomWalks(filepath, 2, 10, -1, 1));
+  REQUIRE_THROWS(g.writeRandomWalks(filepath, 2, 10, 1, -2));
+}
+
+/***************** Test Graph::getSimilarAddresses() ********************/
+
+TEST_CASE("test_tiny_getSimilarAddresses", "[classic]") {
+  Graph g("./tests/tinySample.csv");
+
+  REQUIRE_THROWS(g.getSimilarAddresses("1FckoRapKaVE2kktJ2T3oVoGydjQkGy2z2"));
+
+  g.buildSimilarityIndex();
+
+  // Both addresses only ever sent to 1CUTyyxgbKvtCdoYmceQJCZLXCde5akiX2.
+  vector<pair<string, double>> similar = g.getSimilarAddresses("1FckoRapKaVE2kktJ2T3oVoGydjQkGy2z2");
+  REQUIRE(similar.size() == 1);
+  REQUIRE(similar[0].first == "357oZdnMBzc4KSgeqBrS29BgFUpFmfqpsj");
+  REQUIRE(similar[0].second == 1);
+
+  REQUIRE(g.getSimilarAddresses("bc1qxyvjetj7qdfwxctmgrtxlpa3cts3f5nt86d6kq").empty());
+  REQUIRE(g.getSimilarAddresses("notAnAddress").empty());
+
+  // Adding a transaction discards the index.
+  g.addTransaction("357oZdnMBzc4KSgeqBrS29BgFUpFmfqpsj", 1000, "bc1qq904ynep5mvwpjxdlyecgeupg22dm8am6cfvgq");
+  REQUIRE_THROWS(g.getSimilarAddresses("1FckoRapKaVE2kktJ2T3oVoGydjQkGy2z2"));
+}
+
+TEST_CASE("test_tiny3_getSimilarAddresses", "[classic]") {
+  Graph g("./tests/tinySample3.csv");
+  g.buildSimilarityIndex(256, 64);
+
+  // Counterparties {1Fck, 1CUT} and {1Fck, 1CUT, bc1qq904} have Jaccard similarity 2 / 3.
+  vector<pair<string, double>> similar = g.getSimilarAddresses("357oZdnMBzc4KSgeqBrS29BgFUpFmfqpsj");
+  REQUIRE(!similar.empty());
+  REQUIRE(similar[0].first == "13EV17cfgnK4MsxoQwoVqNr3hSqaGJQob2");
+  REQUIRE(similar[0].second == Approx(2.0 / 3).margin(0.15));
+
+  for (size_t i = 1; i < similar.size(); ++i)
+    REQUIRE(similar[i - 1].second >= similar[i].second);
+}
+
+/*************** Test Graph::getSimilarAddressPairs() *******************/
+
+TEST_CASE("test_tiny_getSimilarAddressPairs", "[classic]") {
+  Graph g("./tests/tinySample.csv");
+  g.buildSimilarityIndex();
+
+  vector<pair<pair<string, string>, double>> pairs = g.getSimilarAddressPairs(0.5);
+  REQUIRE(pairs.size() == 1);
+  REQUIRE(pairs[0].first.first == "1FckoRapKaVE2kktJ2T3oVoGydjQkGy2z2");
+  REQUIRE(pairs[0].first.second == "357oZdnMBzc4KSgeqBrS29BgFUpFmfqpsj");
+  REQUIRE(pairs[0].second == 1);
+}
+
+TEST_CASE("test_getSimilarAddressPairs_oversizedBucket", "[classic]") {
+  Graph g;
+
+  // A and B agree in every band. Each C agrees with them in about half the bands, 
+  // so some of their buckets hold more than two addresses and others only A and B.
+  for (size_t i = 0; i < 5; ++i) {
+    string counterparty = "X" + to_string(i);
+    g.addTransaction("A", 1, counterparty);
+    g.addTransaction("B", 1, counterparty);
+    for (size_t j = 0; j < 3; ++j)
+      g.addTransaction("C" + to_string(j), 1, counterparty);
+  }
+  for (size_t j = 0; j < 3; ++j)
+    g.addTransaction("C" + to_string(j), 1, "Y" + to_string(j));
+
+  g.buildSimilarityIndex(128, 32);
+
+  // Pair is still reported from a band whose bucket is small enough.
+  vector<pair<pair<string, string>, double>> pairs = g.getSimilarAddressPairs(0.9, 2);
+  REQUIRE(pairs.size() == 1);
+  REQUIRE(pairs[0].first == pair<string, string>("A", "B"));
+  REQUIRE(pairs[0].second == 1);
+}
+
+TEST_CASE("test_tiny3_getSimilarAddressPairs", "[classic]") {
+  Graph g("./tests/tinySample3.csv");
+  g.buildSimilarityIndex(256, 64);
+
+  vector<pair<pair<string, string>, double>> pairs = g.getSimilarAddressPairs(0);
+
+  // Every pair is reported once and agrees with the single address query.
+  for (size_t i = 0; i < pairs.size(); ++i) {
+    REQUIRE(pairs[i].first.first < pairs[i].first.second);
+    for (size_t j = i + 1; j < pairs.size(); ++j)
+      REQUIRE(pairs[i].first != pairs[j].first);
+
+    bool found = false;
+    for (const auto& similar : g.getSimilarAddresses(pairs[i].first.first, 10))
+      found |= similar.first == pairs[i].first.second && similar.second == pairs[i].second;
+    REQUIRE(found);
+  }
+
+  REQUIRE(!pairs.empty());
+  REQUIRE(pairs[0].first.first == "13EV17cfgnK4MsxoQwoVqNr3hSqaGJQob2");
+  REQUIRE(pairs[0].first.second == "357oZdnMBzc4KSgeqBrS29BgFUpFmfqpsj");
+}
+
+/*************** Test Graph::getNearestLabeledAddresses() ***************/
+
+TEST_CASE("test_tiny2_getNearestLabeledAddresses", "[classic]") {
+  Graph g("./tests/tinySample2.csv");
+
+  vector<pair<string, Graph::NearestLabel>> nearest = g.getNearestLabeledAddresses({
+    "3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb", "33PWEGbE5TokjHm7mAGbb3ZmcLqTWvZ6cr", "notAnAddress"
+  });
+
+  // Labeled addresses first, then the chain split between the two labels.
+  REQUIRE(nearest.size() == 5);
+  REQUIRE(nearest[0].second.cost == 0);
+  REQUIRE(nearest[1].second.cost == 0);
+
+  map<string, Graph::NearestLabel> nearestByAddress;
+  for (const auto& address : nearest)
+    nearestByAddress[address.first] = address.second;
+
+  REQUIRE(nearestByAddress["38kqvN2sNxJtq4bSY9sYioyk4R7Zo3E5FP"].labeledAddress == "3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb");
+  REQUIRE(nearestByAddress["3N4t1HzpsJipALh1U2dyssvWu9TsNQk4wx"].labeledAddress == "33PWEGbE5TokjHm7mAGbb3ZmcLqTWvZ6cr");
+  REQUIRE(nearestByAddress["3JCBEDhEE1vZyEuB5gz8hM8gtPyAfKPctX"].labeledAddress == "33PWEGbE5TokjHm7mAGbb3ZmcLqTWvZ6cr");
+  REQUIRE(nearestByAddress["3JCBEDhEE1vZyEuB5gz8hM8gtPyAfKPctX"].cost == Approx(1.0 / 4369203126 + 1.0 / 4369092782));
+
+  for (size_t i = 1; i < nearest.size(); ++i)
+    REQUIRE(nearest[i - 1].second.cost <= nearest[i].second.cost);
+}
+
+TEST_CASE("test_tiny2_getNearestLabeledAddresses_towardLabels", "[classic]") {
+  Graph g("./tests/tinySample2.csv");
+
+  vector<pair<string, Graph::NearestLabel>> nearest = g.getNearestLabeledAddresses({
+    "38kqvN2sNxJtq4bSY9sYioyk4R7Zo3E5FP", "3KbdivZweu1JmpjvmRsGhXUrXPsGPEWg8W"
+  }, true);
+
+  map<string, Graph::NearestLabel> nearestByAddress;
+  for (const auto& address : nearest)
+    nearestByAddress[address.first] = address.second;
+
+  // Only addresses sending BTC toward a label are found.
+  REQUIRE(nearest.size() == 6);
+  REQUIRE(nearestByAddress["3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb"].labeledAddress == "38kqvN2sNxJtq4bSY9sYioyk4R7Zo3E5FP");
+  REQUIRE(nearestByAddress["3Hg7czYUWtMbaXe9CgcyLW2fdwqvBy4END"].labeledAddress == "3KbdivZweu1JmpjvmRsGhXUrXPsGPEWg8W");
+  REQUIRE(nearestByAddress["3Hg7czYUWtMbaXe9CgcyLW2fdwqvBy4END"].cost 
+          == Approx(1.0 / 4942169551 + 1.0 / 4942034532 + 1.0 / 4941691436));
+  REQUIRE(nearestByAddress.count("3NqD4hJmhK2ZL7NrQ7J3MFcjxn51kxbkiB") == 0);
+}
+
+/*********************** Test Graph::getMaxFlow() ***********************/
+
+TEST_CASE("test_tiny2_getMaxFlow", "[classic]") {
+  Graph g("./tests/tinySample2.csv");
+
+  // Flow along a chain is limited by its smallest transaction.
+  Graph::MaxFlow maxFlow = g.getMaxFlow("3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb", "3JCBEDhEE1vZyEuB5gz8hM8gtPyAfKPctX");
+  REQUIRE(maxFlow.flow == 4369092782);
+  REQUIRE(maxFlow.cutTransactions.size() == 1);
+  REQUIRE(maxFlow.cutTransactions[0].first == "3N4t1HzpsJipALh1U2dyssvWu9TsNQk4wx");
+  REQUIRE(maxFlow.cutTransactions[0].second == "3JCBEDhEE1vZyEuB5gz8hM8gtPyAfKPctX");
+
+  REQUIRE(g.getMaxFlow("3JCBEDhEE1vZyEuB5gz8hM8gtPyAfKPctX", "3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb").flow == 0);
+  REQUIRE(g.getMaxFlow("3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb", "3NqD4hJmhK2ZL7NrQ7J3MFcjxn51kxbkiB").flow == 0);
+  REQUIRE(g.getMaxFlow("3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb", "notAnAddress").flow == 0);
+
+  // Path is four transactions long.
+  REQUIRE(g.getMaxFlow("3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb", "3JCBEDhEE1vZyEuB5gz8hM8gtPyAfKPctX", 3).flow == 0);
+  REQUIRE(g.getMaxFlow("3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb", "3JCBEDhEE1vZyEuB5gz8hM8gtPyAfKPctX", 4).flow == 4369092782);
+}
+
+TEST_CASE("test_tiny3_getMaxFlow", "[classic]") {
+  Graph g("./tests/tinySample3.csv");
+
+  // BTC reaches 1CUT directly and through 357o.
+  Graph::MaxFlow maxFlow = g.getMaxFlow("1FckoRapKaVE2kktJ2T3oVoGydjQkGy2z2", "1CUTyyxgbKvtCdoYmceQJCZLXCde5akiX2");
+  REQUIRE(maxFlow.flow == 32000000 + 8500000);
+  REQUIRE(maxFlow.cutTransactions.size() == 2);
+
+  long long cutAmount = 0;
+  for (const auto& transaction : maxFlow.cutTransactions) {
+    REQUIRE(transaction.second == "1CUTyyxgbKvtCdoYmceQJCZLXCde5akiX2");
+    cutAmount += g.getTransactionAmount(transaction.first, transaction.second);
+  }
+  REQUIRE(cutAmount == maxFlow.flow);
+
+  // Only the direct transaction is within one hop.
+  REQUIRE(g.getMaxFlow("1FckoRapKaVE2kktJ2T3oVoGydjQkGy2z2", "1CUTyyxgbKvtCdoYmceQJCZLXCde5akiX2", 1).flow == 32000000);
+
+  maxFlow = g.getMaxFlow("357oZdnMBzc4KSgeqBrS29BgFUpFmfqpsj", "bc1qq904ynep5mvwpjxdlyecgeupg22dm8am6cfvgq");
+  REQUIRE(maxFlow.flow == 1094);
+  REQUIRE(maxFlow.cutTransactions.size() == 1);
+  REQUIRE(maxFlow.cutTransactions[0].first == "13EV17cfgnK4MsxoQwoVqNr3hSqaGJQob2");
+}
+
+/********************* Test Graph::getPeelChains() **********************/
+
+TEST_CASE("test_tiny2_getPeelChains", "[classic]") {
+  Graph g("./tests/tinySample2.csv");
+
+  vector<Graph::PeelChain> chains = g.getPeelChains();
+  REQUIRE(chains.size() == 2);
+
+  // Equal lengths are ranked by amount.
+  vector<string> expected = {
+    "3Hg7czYUWtMbaXe9CgcyLW2fdwqvBy4END", "39yzT9McTdzgA9G31uECmXAswfjnhXBtpK", "bc1qv8jxnyy5ta396ztlwptjer5d4q6cntv0qw5rka",
+    "3KbdivZweu1JmpjvmRsGhXUrXPsGPEWg8W", "3NqD4hJmhK2ZL7NrQ7J3MFcjxn51kxbkiB"
+  };
+  REQUIRE(chains[0].addresses == expected);
+  REQUIRE(chains[0].amount == 4942169551);
+  REQUIRE(chains[0].peeledAmount == 0);
+  REQUIRE(chains[1].addresses[0] == "3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb");
+  REQUIRE(chains[1].addresses.size() == 5);
+
+  REQUIRE(g.getPeelChains(1).size() == 4);
+  REQUIRE(g.getPeelChains(5).empty());
+  REQUIRE(g.getPeelChains(1, 4400000000).size() == 1);
+}
+
+TEST_CASE("test_tiny3_getPeelChains", "[classic]") {
+  Graph g("./tests/tinySample3.csv");
+
+  // Chain loops back to 1Fck from 357o and stops before revisiting it.
+  vector<Graph::PeelChain> chains = g.getPeelChains();
+  REQUIRE(chains.size() == 1);
+
+  vector<string> expected = {
+    "1CUTyyxgbKvtCdoYmceQJCZLXCde5akiX2", "13EV17cfgnK4MsxoQwoVqNr3hSqaGJQob2", 
+    "1FckoRapKaVE2kktJ2T3oVoGydjQkGy2z2", "357oZdnMBzc4KSgeqBrS29BgFUpFmfqpsj"
+  };
+  REQUIRE(chains[0].addresses == expected);
+  REQUIRE(chains[0].amount == 40400000);
+  REQUIRE(chains[0].peeledAmount == 1094 + 32000000 + 8500000);
+
+  // 1Fck only sends 82% of its BTC to 357o, so chains end there.
+  chains = g.getPeelChains(1, 0, 0.9);
+  REQUIRE(chains.size() == 2);
+  REQUIRE(chains[0].addresses.size() == 3);
+  REQUIRE(chains[0].addresses[2] == "1FckoRapKaVE2kktJ2T3oVoGydjQkGy2z2");
+  REQUIRE(chains[1].addresses[0] == "357oZdnMBzc4KSgeqBrS29BgFUpFmfqpsj");
+  REQUIRE(chains[1].addresses[1] == "1FckoRapKaVE2kktJ2T3oVoGydjQkGy2z2");
+}
+
+/******************* Test Graph::getDenseSubgraphs() ********************/
+
+TEST_CASE("test_tiny3_getDenseSubgraphs", "[classic]") {
+  Graph g("./tests/tinySample3.csv");
+
+  // 1Fck and 357o send almost 1.5 BTC each way.
+  vector<Graph::DenseSubgraph> subgraphs = g.getDenseSubgraphs(2);
+  REQUIRE(subgraphs.size() == 2);
+
+  vector<string> expected = {"1FckoRapKaVE2kktJ2T3oVoGydjQkGy2z2", "357oZdnMBzc4KSgeqBrS29BgFUpFmfqpsj"};
+  REQUIRE(subgraphs[0].addresses == expected);
+  REQUIRE(subgraphs[0].density == Approx((1.5 + 1.4999) / 2));
+
+  // Densest of what is left after removing the first subgraph.
+  expected = {"1CUTyyxgbKvtCdoYmceQJCZLXCde5akiX2", "13EV17cfgnK4MsxoQwoVqNr3hSqaGJQob2"};
+  REQUIRE(subgraphs[1].addresses == expected);
+  REQUIRE(subgraphs[1].density == Approx(0.404 / 2));
+
+  // Four addresses with five pairs of counterparties.
+  subgraphs = g.getDenseSubgraphs(1, false);
+  REQUIRE(subgraphs.size() == 1);
+  REQUIRE(subgraphs[0].addresses.size() == 4);
+  REQUIRE(subgraphs[0].density == Approx(5.0 / 4));
+}
+
+TEST_CASE("test_tiny3_getDenseSubgraphs_batchPeeling", "[classic]") {
+  Graph g("./tests/tinySample3.csv");
+
+  // Only bc1qq904 is left after two subgraphs.
+  vector<Graph::DenseSubgraph> subgraphs = g.getDenseSubgraphs(5, true, 0.1, true);
+  REQUIRE(subgraphs.size() == 2);
+
+  vector<string> expected = {"1FckoRapKaVE2kktJ2T3oVoGydjQkGy2z2", "357oZdnMBzc4KSgeqBrS29BgFUpFmfqpsj"};
+  REQUIRE(subgraphs[0].addresses == expected);
+  REQUIRE(subgraphs[0].density == Approx((1.5 + 1.4999) / 2));
+
+  // Subgraphs are disjoint.
+  vector<string> seen;
+  for (const Graph::DenseSubgraph& subgraph : subgraphs) {
+    REQUIRE(subgraph.density > 0);
+    for (const string& address : subgraph.addresses) {
+      REQUIRE(find(seen.begin(), seen.end(), address) == seen.end());
+      seen.push_back(address);
+    }
+  }
+}
+
+TEST_CASE("test_small2_getDenseSubgraphs", "[classic]") {
+  Graph g("./tests/smallSample2.csv");
+
+  // Batch peeling is within a factor 2(1 + epsilon) of greedy peeling.
+  vector<Graph::DenseSubgraph> greedy = g.getDenseSubgraphs(1, false);
+  vector<Graph::DenseSubgraph> batch = g.getDenseSubgraphs(1, false, 0.1, true);
+  REQUIRE(greedy.size() == 1);
+  REQUIRE(batch.size() == 1);
+  REQUIRE(batch[0].density * 2 * 1.1 >= greedy[0].density);
+  REQUIRE(greedy[0].density * 2 * 1.1 >= batch[0].density);
+}
+
+/******************* Test writeSyntheticTransactions() ********************/
+
+TEST_CASE("test_getSyntheticAddress", "[classic]") {
+  // Addresses look like legacy Bitcoin addresses and never collide.
+  vector<string> addresses;
+  for (uint64_t addressIdx = 0; addressIdx < 1000; ++addressIdx) {
+    string address = getSyntheticAddress(addressIdx);
+    REQUIRE(address.size() == 34);
+    REQUIRE(address[0] == '1');
+    addresses.push_back(address);
+  }
+
+  sort(addresses.begin(), addresses.end());
+  REQUIRE(unique(addresses.begin(), addresses.end()) == addresses.end());
+}
+
+TEST_CASE("test_writeSyntheticTransactions", "[classic]") {
+  GeneratorOptions options;
+  options.scale = 10;
+  options.transactionCount = 5000;
+  options.seed = 7;
+
+  string filepath = "./tests/synthetic.csv";
+  size_t transactionCount = writeSyntheticTransactions(filepath, options);
+
+  // Duplicate transactions are dropped, so every line is a new edge.
+  Graph g(filepath);
+  REQUIRE(g.getTransactionCount() == transactionCount);
+  REQUIRE(transactionCount > 4000);
+  REQUIRE(transactionCount <= 6000);
+  REQUIRE(g.getAddressCount() <= 1024);
+
+  // Hubs receive a share of all transactions, far more than R-MAT alone gives any address.
+  unordered_map<string, size_t> inDegrees;
+  ifstream file(filepath);
+  string line;
+  while (getline(file, line))
+    ++inDegrees[line.substr(line.rfind(',') + 1)];
+  file.close();
+
+  size_t maxInDegree = 0;
+  for (const auto& inDegree : inDegrees)
+    maxInDegree = max(maxInDegree, inDegree.second);
+  REQUIRE(maxInDegree > 100);
+
+  // Building the graph directly adds the same transactions in the same order.
+  Graph generated = generateSyntheticGraph(options);
+  REQUIRE(generated.getAddressCount() == g.getAddressCount());
+  REQUIRE(generated.getTransactionCount() == g.getTransactionCount());
+  REQUIRE(generated.BFS() == g.BFS());
+
+  remove(filepath.c_str());
+}
+
+TEST_CASE("test_generateSyntheticGraph_seed", "[classic]") {
+  GeneratorOptions options;
+  options.scale = 10;
+  options.transactionCount = 5000;
+
+  // The same seed always generates the same graph.
+  Graph first = generateSyntheticGraph(options);
+  Graph second = generateSyntheticGraph(options);
+  REQUIRE(first.BFS() == second.BFS());
+
+  options.seed = 1;
+  Graph third = generateSyntheticGraph(options);
+  REQUIRE(first.BFS() != third.BFS());
+}
+
+/************************** Test getStats() ***************************/
+
+TEST_CASE("test_tiny2_getStats", "[classic]") {
+  resetStats();
+
+  Graph g("./tests/tinySample2.csv");
+  g.mostLikelyPath("3CYuiCMJzQ9vgomtSE3ZF7ygNfSKqDqjSb", "3JCBEDhEE1vZyEuB5gz8hM8gtPyAfKPctX");
+  g.getAddressesByCentrality();
+
+  Stats stats = getStats();
+  if (statsEnabled()) {
+    // Every address is added once and looked up for every other transaction it is in.
+    REQUIRE(stats.counters[STAT_ADD_NODE_MISSES] == g.getAddressCount());
+    REQUIRE(stats.counters[STAT_ADD_NODE_HITS] + stats.counters[STAT_ADD_NODE_MISSES] == 2 * g.getTransactionCount());
+    REQUIRE(stats.counters[STAT_DUPLICATE_EDGES] == 0);
+    REQUIRE(stats.counters[STAT_CENTRALITY_SOURCES] == g.getAddressCount());
+
+    // Every push is popped, and every push after a source's is a relaxation.
+    REQUIRE(stats.counters[STAT_DIJKSTRA_POPS] == stats.counters[STAT_DIJKSTRA_PUSHES]);
+    REQUIRE(stats.counters[STAT_DIJKSTRA_RELAXATIONS] == stats.counters[STAT_DIJKSTRA_PUSHES] - (g.getAddressCount() + 1));
+    REQUIRE(stats.timerCalls[STAT_LOAD] == 1);
+    REQUIRE(stats.timerCalls[STAT_DIJKSTRA] == g.getAddressCount() + 1);
+  } else {
+    // Recording compiles to nothing.
+    for (size_t i = 0; i < STAT_COUNTER_COUNT; ++i)
+      REQUIRE(stats.counters[i] == 0);
+    for (size_t i = 0; i < STAT_TIMER_COUNT; ++i)
+      REQUIRE(stats.timerCalls[i] == 0);
+  }
+
+  resetStats();
+  REQUIRE(getStats().counters[STAT_ADD_NODE_MISSES] == 0);
+}
+
+/*********************** Test PerfCounters::stop() ***********************/
+
+TEST_CASE("test_small2_PerfCounters", "[classic]") {
+  // Counters may not be permitted, in which case phases are still timed.
+  PerfCounters counters;
+  if (!counters.isAvailable())
+    REQUIRE(!counters.getError().empty());
+
+  counters.start();
+  Graph g("./tests/smallSample2.csv");
+  g.getAddressesByCentrality();
+  PerfSample sample = counters.stop();
+
+  REQUIRE(sample.seconds >= 0);
+  if (sample.available[PERF_INSTRUCTIONS])
+    REQUIRE(sample.values[PERF_INSTRUCTIONS] > 0);
+
+  // Unavailable events are printed as n/a instead of failing.
+  stringstream out;
+  writePerfSample(out, "test", sample, g.getTransactionCount());
+  REQUIRE(out.str().find("Perf counters for test") == 0);
+  if (!counters.isAvailable())
+    REQUIRE(out.str().find("IPC n/a") != string::npos);
+}
+
+/************************* Test writeTraceJson() *************************/
+
+/**
+ * @brief Count occurrences of substring in string.
+ */
+size_t countOccurrences(const string& str, const string& substring) {
+  size_t count = 0;
+  for (size_t pos = str.find(substring); pos != string::npos; pos = str.find(substring, pos + 1))
+    ++count;
+  return count;
+}
+
+TEST_CASE("test_tiny2_writeTraceJson", "[classic]") {
+  startTracing();
+  Graph g("./tests/tinySample2.csv");
+  g.BFS();
+  g.getAddressesByCentrality();
+  stopTracing();
+
+  // Spans after tracing stops are not recorded.
+  g.getAddressesByCentrality();
+
+  stringstream out;
+  writeTraceJson(out);
+  string trace = out.str();
+
+  REQUIRE(trace.find("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [") == 0);
+  REQUIRE(countOccurrences(trace, "\"name\": \"load chunk\"") == 1);
+  REQUIRE(countOccurrences(trace, "\"name\": \"centrality source\"") == g.getAddressCount());
+  REQUIRE(countOccurrences(trace, "\"name\": \"BFS level\"") >= 1);
+  REQUIRE(countOccurrences(trace, "\"ph\": \"X\"") == countOccurrences(trace, "\"dur\": "));
+}
+
+TEST_CASE("test_writeTraceJson_ringBuffer", "[classic]") {
+  // Only the newest spans are kept once a buffer is full.
+  startTracing(4);
+  for (int64_t i = 0; i < 10; ++i)
+    TraceSpan span("span", "test", i);
+  stopTracing();
+
+  stringstream out;
+  writeTraceJson(out);
+  string trace = out.str();
+
+  REQUIRE(countOccurrences(trace, "\"name\": \"span\"") == 4);
+  REQUIRE(trace.find("\"index\": 5}") == string::npos);
+  REQUIRE(trace.find("\"index\": 6}") != string::npos);
+  REQUIRE(trace.find("\"index\": 9}") != string::npos);
+}
+
+/*********************** Test Graph::memoryUsage() ***********************/
+
+TEST_CASE("test_small2_memoryUsage", "[classic]") {
+  HeapUsage before = getHeapUsage();
+  Graph* g = new Graph("./tests/smallSample2.csv");
+  HeapUsage after = getHeapUsage();
+
+  Graph::MemoryUsage usage = g -> memoryUsage();
+
+  size_t bytes = 0, allocations = 0, slackBytes = 0;
+  for (const Graph::MemoryUsageEntry& entry : usage.entries) {
+    REQUIRE(entry.slackBytes <= entry.bytes);
+    bytes += entry.bytes;
+    allocations += entry.allocations;
+    slackBytes += entry.slackBytes;
+  }
+
+  REQUIRE(usage.bytes == bytes);
+  REQUIRE(usage.allocations == allocations);
+  REQUIRE(usage.slackBytes == slackBytes);
+
+  // Every transaction is indexed by its sender and its recipient.
+  REQUIRE(usage.entries[0].name == "nodes_");
+  REQUIRE(usage.entries[0].bytes >= g -> getAddressCount() * (sizeof(string) + 3 * sizeof(size_t)));
+  REQUIRE(usage.entries[5].name == "outbound vectors");
+  REQUIRE(usage.entries[5].bytes - usage.entries[5].slackBytes == g -> getTransactionCount() * sizeof(size_t));
+  REQUIRE(usage.entries[6].bytes - usage.entries[6].slackBytes == g -> getTransactionCount() * sizeof(size_t));
+
+  // Estimate is exact when allocations are counted, the graph object itself aside.
+  if (heapCountingEnabled()) {
+    REQUIRE(after.bytes - before.bytes == usage.bytes + sizeof(Graph));
+    REQUIRE(after.allocations - before.allocations == usage.allocations + 1);
+  }
+
+  delete g;
+}
+
+/************************* Test BufferedWriter **************************/
+
+/**
+ * @brief Read whole file into string.
+ */
+string readFile(const string& filepath) {
+  ifstream file(filepath);
+  stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+TEST_CASE("test_BufferedWriter", "[classic]") {
+  string filepath = "./tests/writer.txt";
+
+  // Small buffers are written many times, in the foreground and in the background.
+  for (bool background : {false, true}) {
+    string expected;
+    BufferedWriter writer(filepath, background, 64);
+    for (uint64_t i = 0; i < 1000; ++i) {
+      writer.writeLine("line");
+      writer.writeNumber(i * 1000003);
+      writer.put('\n');
+      expected += "line\n" + to_string(i * 1000003) + "\n";
+    }
+    writer.writeNumber(0);
+    expected += "0";
+
+    REQUIRE(writer.getBytesWritten() == expected.size());
+    writer.close();
+    REQUIRE(readFile(filepath) == expected);
+  }
+
+  remove(filepath.c_str());
+
+  REQUIRE_THROWS(BufferedWriter("./tests/missing/writer.txt"));
+}
+
+TEST_CASE("test_small2_writeBFS", "[classic]") {
+  Graph g("./tests/smallSample2.csv");
+  string filepath = "./tests/smallSample2BFS.txt";
+
+  BufferedWriter writer(filepath, true, 128);
+  REQUIRE(g.writeBFS(writer) == g.getAddressCount());
+  writer.close();
+
+  // Same addresses in the same order as BFS().
+  string expected;
+  for (const string& address : g.BFS())
+    expected += address + "\n";
+
+  REQUIRE(readFile(filepath) == expected);
+  remove(filepath.c_str());
+}
+
+/*************************** Test QueryServer ***************************/
+
+TEST_CASE("test_QueryMessage", "[classic]") {
+  QueryMessage message;
+  message.putUint8(QUERY_PATH);
+  message.putUint32(4000000000u);
+  message.putUint64((uint64_t) -5);
+  message.putString("address");
+
+  QueryMessage read(message.getBytes());
+  REQUIRE(read.getUint8() == QUERY_PATH);
+  REQUIRE(read.getUint32() == 4000000000u);
+  REQUIRE((long long) read.getUint64() == -5);
+  REQUIRE(read.getString() == "address");
+  REQUIRE_THROWS(read.getUint8());
+
+  // Length of string runs past the end of the message.
+  QueryMessage truncated(message.getBytes().substr(0, message.getBytes().size() - 1));
+  truncated.getUint8();
+  truncated.getUint32();
+  truncated.getUint64();
+  REQUIRE_THROWS(truncated.getString());
+}
+
+TEST_CASE("test_small2_QueryServer", "[classic]") {
+  Graph g("./tests/smallSample2.csv");
+  string socketPath = "./tests/query.sock";
+
+  QueryServer server(g, socketPath, 2);
+  thread serving(&QueryServer::serve, &server);
+
+  vector<string> addresses = g.BFS();
+  addresses.push_back("missing");
+
+  // Clients on several threads are answered like the graph itself.
+  vector<thread> clients;
+  vector<int> matched(3, 0);
+  for (size_t clientIdx = 0; clientIdx < matched.size(); ++clientIdx) {
+    clients.emplace_back([&, clientIdx] () {
+      QueryClient client(socketPath);
+      bool matches = true;
+
+      for (const string& sender : addresses) {
+        matches &= client.addressExists(sender) == g.addressExists(sender);
+        matches &= client.getAddressBalance(sender) == g.getAddressBalance(sender);
+
+        for (const string& recipient : addresses) {
+          matches &= client.getTransactionAmount(sender, recipient) == g.getTransactionAmount(sender, recipient);
+          matches &= client.mostLikelyPath(sender, recipient) == g.mostLikelyPath(sender, recipient);
+        }
+      }
+
+      matched[clientIdx] = matches;
+    });
+  }
+
+  for (thread& client : clients)
+    client.join();
+
+  REQUIRE(matched == vector<int>(matched.size(), 1));
+
+  QueryClient client(socketPath);
+  vector<pair<string, unsigned int>> centrality = g.getAddressesByCentrality();
+  vector<pair<string, uint64_t>> top = client.getTopCentrality(3);
+
+  REQUIRE(top.size() == 3);
+  for (size_t rank = 0; rank < top.size(); ++rank) {
+    REQUIRE(top[rank].first == centrality[rank].first);
+    REQUIRE(top[rank].second == centrality[rank].second);
+  }
+
+  // Sampling more addresses than the graph has is sampling every address.
+  REQUIRE(client.getTopCentrality(3, g.getAddressCount() + 5) == top);
+  REQUIRE(client.getTopCentrality(3, g.getAddressCount()) == top);
+
+  // Rankings of older sampling sizes are dropped and computed again.
+  for (uint32_t samplingSize = 1; samplingSize <= 6; ++samplingSize)
+    REQUIRE(client.getTopCentrality(3, samplingSize).size() <= 3);
+  REQUIRE(client.getTopCentrality(3) == top);
+
+  server.stop();
+  serving.join();
+
+  REQUIRE(server.getRequestCount() > 0);
+  REQUIRE_THROWS(client.addressExists(addresses[0]));
+}
+
+TEST_CASE("test_small2_QueryServer_stalledClient", "[classic]") {
+  Graph g("./tests/smallSample2.csv");
+  string socketPath = "./tests/query.sock";
+
+  // Only thread of the server is taken by the stalled client first.
+  QueryServer server(g, socketPath, 1, 1);
+  thread serving(&QueryServer::serve, &server);
+
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, socketPath.c_str());
+
+  int stalledFd = socket(AF_UNIX, SOCK_STREAM, 0);
+  REQUIRE(connect(stalledFd, (sockaddr*) &address, sizeof(address)) == 0);
+
+  // Half of the frame length, never followed by the rest.
+  char partial[2] = { 0, 0 };
+  REQUIRE(write(stalledFd, partial, sizeof(partial)) == sizeof(partial));
+  std::this_thread::sleep_for(milliseconds(100));
+
+  QueryClient client(socketPath);
+  vector<string> addresses = g.BFS();
+  REQUIRE(client.addressExists(addresses[0]));
+
+  // Stalled connection was closed by the server.
+  char byte;
+  REQUIRE(read(stalledFd, &byte, 1) == 0);
+  close(stalledFd);
+
+  server.stop();
+  serving.join();
+}
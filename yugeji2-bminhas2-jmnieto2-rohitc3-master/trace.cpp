@@ -0,0 +1,195 @@
+#include "trace.h"
+
+#include <chrono>
+using std::chrono::steady_clock;
+using std::chrono::nanoseconds;
+using std::chrono::duration_cast;
+
+#include <memory>
+using std::unique_ptr;
+
+#include <mutex>
+using std::mutex;
+using std::lock_guard;
+
+#include <vector>
+using std::vector;
+
+#include <iostream>
+using std::endl;
+
+std::atomic<bool> tracingEnabled(false);
+
+/**
+ * Span recorded by a thread.
+ */
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    uint64_t begin;
+    uint64_t end;
+    int64_t arg;
+};
+
+/**
+ * Ring buffer of spans, written by one thread at a time.
+ */
+struct TraceBuffer {
+    size_t lane;                  // Index of buffer, shown as thread id.
+    vector<TraceEvent> events;
+    uint64_t recorded = 0;        // Spans recorded, including overwritten ones.
+};
+
+/**
+ * Every buffer and those not held by a thread.
+ */
+struct TraceRegistry {
+    mutex lock;
+    vector<unique_ptr<TraceBuffer>> buffers;
+    vector<TraceBuffer*> freeBuffers;
+    size_t eventsPerThread = 1 << 18;
+    uint64_t startTime = 0;
+};
+
+/**
+ * @brief Get registry shared by all threads.
+ *
+ * @return TraceRegistry& Registry, never destroyed so threads exiting after main still find it.
+ */
+static TraceRegistry& _getRegistry() {
+    static TraceRegistry* registry = new TraceRegistry();
+    return *registry;
+}
+
+/**
+ * Buffer held by a thread from its first span until it exits.
+ */
+struct ThreadTraceBuffer {
+    TraceBuffer* buffer = nullptr;
+
+    ~ThreadTraceBuffer() {
+        if (!buffer)
+            return;
+
+        TraceRegistry& registry = _getRegistry();
+        lock_guard<mutex> guard(registry.lock);
+        registry.freeBuffers.push_back(buffer);
+    }
+};
+
+/**
+ * @brief Get buffer of calling thread, taking a free one on its first span.
+ *
+ * @return TraceBuffer& Buffer only written by calling thread.
+ */
+static TraceBuffer& _getThreadBuffer() {
+    thread_local ThreadTraceBuffer threadBuffer;
+
+    if (!threadBuffer.buffer) {
+        TraceRegistry& registry = _getRegistry();
+        lock_guard<mutex> guard(registry.lock);
+
+        if (registry.freeBuffers.empty()) {
+            registry.buffers.emplace_back(new TraceBuffer());
+            registry.buffers.back() -> lane = registry.buffers.size() - 1;
+            registry.buffers.back() -> events.resize(registry.eventsPerThread);
+            registry.freeBuffers.push_back(registry.buffers.back().get());
+        }
+
+        // Reuse the earliest lane so lanes stay few.
+        auto earliest = registry.freeBuffers.begin();
+        for (auto it = registry.freeBuffers.begin(); it != registry.freeBuffers.end(); ++it) {
+            if ((*it) -> lane < (*earliest) -> lane)
+                earliest = it;
+        }
+
+        threadBuffer.buffer = *earliest;
+        registry.freeBuffers.erase(earliest);
+    }
+
+    return *threadBuffer.buffer;
+}
+
+/**
+ * @brief Write nanoseconds as microseconds with three decimals,
+ * without the rounding of default stream precision.
+ *
+ * @param out  Stream to write to.
+ * @param time Nanoseconds to write.
+ */
+static void _writeMicroseconds(ostream& out, uint64_t time) {
+    char fraction[4] = { (char) ('0' + time / 100 % 10), (char) ('0' + time / 10 % 10), 
+                         (char) ('0' + time % 10), '\0' };
+    out << time / 1000 << "." << fraction;
+}
+
+uint64_t getTraceTime() {
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count() + 1;
+}
+
+void recordTraceSpan(const char* name, const char* category, uint64_t begin, int64_t arg) {
+    TraceBuffer& buffer = _getThreadBuffer();
+    if (buffer.events.empty())
+        return;
+
+    buffer.events[buffer.recorded % buffer.events.size()] = { name, category, begin, getTraceTime(), arg };
+    ++buffer.recorded;
+}
+
+void startTracing(size_t eventsPerThread) {
+    TraceRegistry& registry = _getRegistry();
+    lock_guard<mutex> guard(registry.lock);
+
+    registry.eventsPerThread = eventsPerThread;
+    for (const unique_ptr<TraceBuffer>& buffer : registry.buffers) {
+        buffer -> events.assign(eventsPerThread, TraceEvent());
+        buffer -> recorded = 0;
+    }
+
+    registry.startTime = getTraceTime();
+    tracingEnabled.store(true);
+}
+
+void stopTracing() {
+    tracingEnabled.store(false);
+}
+
+void writeTraceJson(ostream& out) {
+    TraceRegistry& registry = _getRegistry();
+    lock_guard<mutex> guard(registry.lock);
+
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+    bool first = true;
+    for (const unique_ptr<TraceBuffer>& buffer : registry.buffers) {
+        out << (first ? "" : ",\n")
+            << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": " << buffer -> lane
+            << ", \"args\": {\"name\": \"lane " << buffer -> lane << "\"}}";
+        first = false;
+
+        // Oldest kept span is the one after the last written, once buffer has wrapped.
+        size_t capacity = buffer -> events.size();
+        uint64_t kept = buffer -> recorded < capacity ? buffer -> recorded : capacity;
+
+        for (uint64_t i = buffer -> recorded - kept; i < buffer -> recorded; ++i) {
+            const TraceEvent& event = buffer -> events[i % capacity];
+            if (event.begin < registry.startTime)
+                continue;
+
+            // Chrome traces are in microseconds.
+            out << ",\n{\"name\": \"" << event.name << "\", \"cat\": \"" << event.category
+                << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << buffer -> lane
+                << ", \"ts\": ";
+            _writeMicroseconds(out, event.begin - registry.startTime);
+            out << ", \"dur\": ";
+            _writeMicroseconds(out, event.end - event.begin);
+
+            if (event.arg >= 0)
+                out << ", \"args\": {\"index\": " << event.arg << "}";
+
+            out << "}";
+        }
+    }
+
+    out << "\n]}" << endl;
+}
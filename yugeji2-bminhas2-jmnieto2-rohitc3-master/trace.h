@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+
+#include <atomic>
+
+#include <ostream>
+using std::ostream;
+
+// True while tracing, read with a single relaxed load by every span.
+extern std::atomic<bool> tracingEnabled;
+
+/**
+ * @brief Check if spans are being recorded.
+ *
+ * @return bool True between startTracing() and stopTracing().
+ */
+inline bool isTracing() {
+    return tracingEnabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Get current time of trace clock.
+ *
+ * @return uint64_t Nanoseconds on a monotonic clock, never 0.
+ */
+uint64_t getTraceTime();
+
+/**
+ * @brief Record span of calling thread into its ring buffer.
+ *
+ * @param name     Name of span, must outlive tracing like a string literal.
+ * @param category Category of span, must outlive tracing like a string literal.
+ * @param begin    Time span began at from getTraceTime().
+ * @param arg      Number shown with span, like an index, ignored if negative.
+ *
+ * Only the calling thread writes its buffer, so recording takes
+ * no locks. The oldest spans are overwritten once it is full.
+ */
+void recordTraceSpan(const char* name, const char* category, uint64_t begin, int64_t arg = -1);
+
+/**
+ * @brief Get time a span begins at, if tracing.
+ *
+ * @return uint64_t Time from getTraceTime(), 0 if not tracing.
+ */
+inline uint64_t traceBegin() {
+    return isTracing() ? getTraceTime() : 0;
+}
+
+/**
+ * @brief Record span begun by traceBegin(), if it was tracing.
+ *
+ * @param name     Name of span.
+ * @param category Category of span.
+ * @param begin    Time from traceBegin().
+ * @param arg      Number shown with span, ignored if negative.
+ */
+inline void traceEnd(const char* name, const char* category, uint64_t begin, int64_t arg = -1) {
+    if (begin)
+        recordTraceSpan(name, category, begin, arg);
+}
+
+/**
+ * Records span from its construction to its destruction.
+ */
+class TraceSpan {
+public:
+    TraceSpan(const char* name, const char* category, int64_t arg = -1)
+        : name_(name), category_(category), arg_(arg), begin_(traceBegin()) { }
+
+    ~TraceSpan() {
+        traceEnd(name_, category_, begin_, arg_);
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    const char* category_;
+    int64_t arg_;
+    uint64_t begin_;
+};
+
+/**
+ * @brief Clear recorded spans and start recording.
+ *
+ * @param eventsPerThread Spans kept in the ring buffer of each thread.
+ */
+void startTracing(size_t eventsPerThread = 1 << 18);
+
+/**
+ * @brief Stop recording spans, keeping those recorded.
+ */
+void stopTracing();
+
+/**
+ * @brief Write recorded spans as Chrome trace-event JSON,
+ * which trace viewers like Perfetto and chrome://tracing open.
+ *
+ * @param out Stream to write to.
+ *
+ * Threads reuse ring buffers of exited threads, so each buffer
+ * is shown as one lane of work. Must not run while spans are recorded.
+ */
+void writeTraceJson(ostream& out);
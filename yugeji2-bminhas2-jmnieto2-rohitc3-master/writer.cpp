@@ -0,0 +1,162 @@
+#include "writer.h"
+#include "trace.h"
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <utility>
+using std::move;
+
+using std::unique_lock;
+using std::lock_guard;
+
+// Full buffers queued for background thread before formatting waits for it.
+static const size_t MAX_PENDING_BUFFERS = 2;
+
+BufferedWriter::BufferedWriter(const string& filepath, bool background, size_t bufferSize)
+    : filepath_(filepath), bufferSize_(bufferSize > 0 ? bufferSize : 1), background_(background) {
+    fd_ = open(filepath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0)
+        throw string("File \"" + filepath + "\" cannot be written!");
+
+    buffer_.reserve(bufferSize_ + 4096);
+
+    if (background_)
+        thread_ = thread(&BufferedWriter::_writePending, this);
+}
+
+BufferedWriter::~BufferedWriter() {
+    try {
+        close();
+    } catch (...) { }
+}
+
+void BufferedWriter::writeNumber(uint64_t value) {
+    char digits[20];
+    size_t count = 0;
+
+    do {
+        digits[sizeof(digits) - ++count] = (char) ('0' + value % 10);
+        value /= 10;
+    } while (value);
+
+    write(digits + sizeof(digits) - count, count);
+}
+
+void BufferedWriter::close() {
+    if (fd_ < 0)
+        return;
+
+    // Background thread is joined and file closed even if writing failed.
+    string error;
+    try {
+        if (!buffer_.empty())
+            _submitBuffer();
+    } catch (const string& e) {
+        error = e;
+    }
+
+    if (background_) {
+        {
+            lock_guard<mutex> guard(lock_);
+            closing_ = true;
+        }
+
+        changed_.notify_all();
+        thread_.join();
+
+        if (error.empty())
+            error = error_;
+    }
+
+    if (::close(fd_) != 0 && error.empty())
+        error = "File \"" + filepath_ + "\" cannot be written!";
+    fd_ = -1;
+
+    if (!error.empty())
+        throw error;
+}
+
+size_t BufferedWriter::getBytesWritten() const {
+    return submittedBytes_ + buffer_.size();
+}
+
+void BufferedWriter::_submitBuffer() {
+    submittedBytes_ += buffer_.size();
+
+    if (!background_) {
+        TraceSpan span("write buffer", "output");
+        if (!_writeAll(buffer_.data(), buffer_.size()))
+            throw string("File \"" + filepath_ + "\" cannot be written!");
+
+        buffer_.clear();
+        return;
+    }
+
+    unique_lock<mutex> guard(lock_);
+
+    // Wait rather than queue without bound when writing falls behind.
+    changed_.wait(guard, [&] () { return pending_.size() < MAX_PENDING_BUFFERS || !error_.empty(); });
+    if (!error_.empty())
+        throw error_;
+
+    pending_.push_back(move(buffer_));
+
+    if (free_.empty()) {
+        buffer_ = string();
+        buffer_.reserve(bufferSize_ + 4096);
+    } else {
+        buffer_ = move(free_.back());
+        free_.pop_back();
+    }
+
+    guard.unlock();
+    changed_.notify_all();
+}
+
+bool BufferedWriter::_writeAll(const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd_, data, size);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+
+        data += written;
+        size -= written;
+    }
+
+    return true;
+}
+
+void BufferedWriter::_writePending() {
+    unique_lock<mutex> guard(lock_);
+
+    while (true) {
+        changed_.wait(guard, [&] () { return !pending_.empty() || closing_; });
+        if (pending_.empty())
+            return;
+
+        string buffer = move(pending_.front());
+        pending_.pop_front();
+
+        // Formatting continues while buffer is written.
+        guard.unlock();
+        bool written;
+        {
+            TraceSpan span("write buffer", "output");
+            written = _writeAll(buffer.data(), buffer.size());
+        }
+        buffer.clear();
+        guard.lock();
+
+        if (!written && error_.empty())
+            error_ = "File \"" + filepath_ + "\" cannot be written!";
+
+        free_.push_back(move(buffer));
+        changed_.notify_all();
+    }
+}
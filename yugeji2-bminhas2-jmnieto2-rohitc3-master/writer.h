@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstdint>
+
+#include <condition_variable>
+using std::condition_variable;
+
+#include <deque>
+using std::deque;
+
+#include <mutex>
+using std::mutex;
+
+#include <string>
+using std::string;
+
+#include <thread>
+using std::thread;
+
+#include <vector>
+using std::vector;
+
+/**
+ * Writes output files through large reusable buffers,
+ * so millions of lines take few write calls.
+ *
+ * Lines are formatted into the current buffer, which is written
+ * once full. With a background thread, full buffers are written
+ * by it while the next ones are formatted, overlapping output
+ * with the computation producing it.
+ */
+class BufferedWriter {
+public:
+    /**
+     * @brief Open file for writing, truncating it.
+     *
+     * @param filepath   Path of file to write.
+     * @param background If true, full buffers are written by a background thread.
+     * @param bufferSize Bytes formatted before a buffer is written.
+     * @throws string if file cannot be opened.
+     */
+    explicit BufferedWriter(const string& filepath, bool background = false, size_t bufferSize = 1 << 22);
+
+    /**
+     * @brief Write what is left and close file, ignoring errors.
+     * Call close() to be told of them.
+     */
+    ~BufferedWriter();
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    /**
+     * @brief Append bytes to file.
+     *
+     * @param data Bytes to append.
+     * @param size Number of bytes.
+     * @throws string if an earlier buffer could not be written.
+     */
+    void write(const char* data, size_t size) {
+        buffer_.append(data, size);
+        if (buffer_.size() >= bufferSize_)
+            _submitBuffer();
+    }
+
+    /**
+     * @brief Append string to file.
+     *
+     * @param str String to append.
+     */
+    void write(const string& str) {
+        write(str.data(), str.size());
+    }
+
+    /**
+     * @brief Append string and newline to file.
+     *
+     * @param str String to append.
+     */
+    void writeLine(const string& str) {
+        buffer_.append(str);
+        buffer_ += '\n';
+        if (buffer_.size() >= bufferSize_)
+            _submitBuffer();
+    }
+
+    /**
+     * @brief Append character to file.
+     *
+     * @param c Character to append.
+     */
+    void put(char c) {
+        buffer_ += c;
+        if (buffer_.size() >= bufferSize_)
+            _submitBuffer();
+    }
+
+    /**
+     * @brief Append unsigned number in decimal to file, without a temporary string.
+     *
+     * @param value Number to append.
+     */
+    void writeNumber(uint64_t value);
+
+    /**
+     * @brief Write what is left, wait for the background thread and close file.
+     *
+     * @throws string if any buffer could not be written.
+     */
+    void close();
+
+    /**
+     * @brief Get number of bytes appended so far.
+     *
+     * @return size_t Bytes appended, written or not.
+     */
+    size_t getBytesWritten() const;
+
+private:
+    int fd_;
+    string filepath_;
+    size_t bufferSize_;
+    size_t submittedBytes_ = 0;
+
+    // Buffer being formatted.
+    string buffer_;
+
+    // Full buffers waiting for background thread, and written buffers to reuse.
+    bool background_;
+    thread thread_;
+    mutex lock_;
+    condition_variable changed_;
+    deque<string> pending_;
+    vector<string> free_;
+    bool closing_ = false;
+    string error_;
+
+    /**
+     * @brief Write current buffer, or hand it to the background thread
+     * and continue with a written one.
+     *
+     * @throws string if a buffer could not be written.
+     */
+    void _submitBuffer();
+
+    /**
+     * @brief Write every byte of data to file, retrying partial writes.
+     *
+     * @param data Bytes to write.
+     * @param size Number of bytes.
+     * @return bool True if every byte was written.
+     */
+    bool _writeAll(const char* data, size_t size);
+
+    /**
+     * @brief Write buffers handed to background thread until closed.
+     */
+    void _writePending();
+};